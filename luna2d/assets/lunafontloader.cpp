@@ -23,12 +23,17 @@
 
 #include "lunafontloader.h"
 #include "lunafontgenerator.h"
+#include "lunafontcache.h"
+#include "lunaglyphatlas.h"
+#include "lunaplatformutils.h"
 #include "lunafiles.h"
 #include "lunajsonutils.h"
 
 using namespace luna2d;
 using namespace json11;
 
+const int DYNAMIC_FONT_PAGE_SIZE = 512; // Default size of glyph atlas page for dynamic fonts
+
 bool LUNAFontLoader::Load(const std::string& filename)
 {
 	LUNAFiles* files = LUNAEngine::SharedFiles();
@@ -46,16 +51,105 @@ bool LUNAFontLoader::Load(const std::string& filename)
 		return false;
 	}
 
-	// Load font file
-	LUNAFontGenerator generator;
-	if(!generator.Load(filename)) return false;
+	// Font file is hashed for cache key. FreeType is loaded only when some size isn't found in cache
+	std::vector<unsigned char> fontData = files->ReadFile(filename);
+	if(fontData.empty()) return false;
+
+	LUNAFontCache cache(fontData);
+	auto generator = std::make_shared<LUNAFontGenerator>(); // Shared with glyph atlases of dynamic fonts
+	bool generatorLoaded = false;
+
+	auto loadGenerator = [&]() -> bool
+	{
+		if(!generatorLoaded) generatorLoaded = generator->Load(filename);
+		return generatorLoaded;
+	};
+
+	// Get baked font with given size from cache or generate it
+	auto bakeFont = [&](const std::string& name, int size, LUNABakedFont& bakedFont) -> bool
+	{
+		LUNAPlatformUtils* utils = LUNAEngine::SharedPlatformUtils();
+		double startTime = utils->GetSystemTime();
+
+		float bakeTime = 0;
+		if(cache.Read(*generator, size, bakedFont, bakeTime))
+		{
+			float loadTime = utils->GetSystemTime() - startTime;
+			LUNA_LOG("Font cache hit for \"%s\" size \"%s\": loaded in %.1f ms, saved %.1f ms",
+				filename.c_str(), name.c_str(), loadTime * 1000.0f, (bakeTime - loadTime) * 1000.0f);
+			return true;
+		}
+
+		if(!loadGenerator()) return false;
+		if(!generator->BakeFont(size, bakedFont)) return false;
+
+		bakeTime = utils->GetSystemTime() - startTime;
+		cache.Write(*generator, bakedFont, bakeTime);
+		LUNA_LOG("Font cache miss for \"%s\" size \"%s\": baked in %.1f ms",
+			filename.c_str(), name.c_str(), bakeTime * 1000.0f);
+
+		return true;
+	};
+
+	// Get bitmap font with given size
+	auto makeFont = [&](const std::string& name, int size) -> std::shared_ptr<LUNAFont>
+	{
+		LUNABakedFont bakedFont;
+		return bakeFont(name, size, bakedFont) ? bakedFont.MakeFont() : nullptr;
+	};
+
+	// Make font rasterizing chars on first use to atlas page with given size
+	auto makeDynamicFont = [&](int size, float outlineSize, int pageSize) -> std::shared_ptr<LUNAFont>
+	{
+		if(!loadGenerator()) return nullptr;
+
+		auto atlas = std::make_shared<LUNAGlyphAtlas>(generator, size, outlineSize, pageSize);
+		return std::make_shared<LUNAFont>(atlas, size, outlineSize);
+	};
+
+	// Distance field fonts of all sizes share one atlas with union of char sets of these sizes
+	std::vector<std::pair<std::string, Json>> sdfSizes;
+	generator->ResetCharSets();
+	generator->enableLatin = generator->enableDiactritic = generator->enableCyrillic = false;
+	generator->enableCommon = generator->enableNumbers = false;
+
+	for(auto entry : jsonDesc.object_items())
+	{
+		auto sizeParams = entry.second;
+		if(!sizeParams.is_object() || !sizeParams["sdf"].bool_value() || !sizeParams["size"].is_number()) continue;
+
+		// Without "chars" param all default char sets are enabled
+		auto jsonChars = sizeParams["chars"];
+		bool allChars = !jsonChars.is_object();
+		generator->enableLatin |= allChars || jsonChars["latin"].bool_value();
+		generator->enableDiactritic |= allChars || jsonChars["diactritic"].bool_value();
+		generator->enableCyrillic |= allChars || jsonChars["cyrillic"].bool_value();
+		generator->enableCommon |= allChars || jsonChars["common"].bool_value();
+		generator->enableNumbers |= allChars || jsonChars["numbers"].bool_value();
+		generator->customSymbols += utf::ToUtf32(jsonChars["custom"].string_value());
+
+		sdfSizes.push_back(entry);
+	}
+
+	if(!sdfSizes.empty())
+	{
+		generator->sdfSpread = SDF_SPREAD;
+
+		LUNABakedFont sdfFont;
+		auto texture = bakeFont("sdf", SDF_FONT_SIZE, sdfFont) ? sdfFont.MakeTexture() : nullptr;
+
+		for(const auto& entry : sdfSizes)
+		{
+			fonts[entry.first] = sdfFont.MakeSdfFont(texture, entry.second["size"].int_value(), entry.second["outline"].number_value());
+		}
+	}
 
 	// Generate bitmap fonts for each specifed size in description file
 	for(auto entry : jsonDesc.object_items())
 	{
-		generator.ResetCharSets();
+		generator->ResetCharSets();
 
-		if(entry.second.is_number()) fonts[entry.first] = generator.GenerateFont(entry.second.int_value());
+		if(entry.second.is_number()) fonts[entry.first] = makeFont(entry.first, entry.second.int_value());
 		else if(entry.second.is_object())
 		{
 			auto sizeParams = entry.second;
@@ -66,20 +160,31 @@ bool LUNAFontLoader::Load(const std::string& filename)
 				continue;
 			}
 
+			// Distance field fonts are already made from shared atlas
+			if(sizeParams["sdf"].bool_value()) continue;
+
+			// Dynamic fonts have no fixed char set
+			if(sizeParams["dynamic"].bool_value())
+			{
+				int pageSize = sizeParams["pageSize"].is_number() ? sizeParams["pageSize"].int_value() : DYNAMIC_FONT_PAGE_SIZE;
+				fonts[entry.first] = makeDynamicFont(sizeParams["size"].int_value(), sizeParams["outline"].number_value(), pageSize);
+				continue;
+			}
+
 			auto jsonChars = sizeParams["chars"];
 			if(jsonChars.is_object())
 			{
-				generator.enableLatin = jsonChars["latin"].bool_value() == true;
-				generator.enableDiactritic = jsonChars["diactritic"].bool_value() == true;
-				generator.enableCyrillic = jsonChars["cyrillic"].bool_value() == true;
-				generator.enableCommon = jsonChars["common"].bool_value() == true;
-				generator.enableNumbers = jsonChars["numbers"].bool_value() == true;
-				generator.customSymbols = utf::ToUtf32(jsonChars["custom"].string_value());
+				generator->enableLatin = jsonChars["latin"].bool_value() == true;
+				generator->enableDiactritic = jsonChars["diactritic"].bool_value() == true;
+				generator->enableCyrillic = jsonChars["cyrillic"].bool_value() == true;
+				generator->enableCommon = jsonChars["common"].bool_value() == true;
+				generator->enableNumbers = jsonChars["numbers"].bool_value() == true;
+				generator->customSymbols = utf::ToUtf32(jsonChars["custom"].string_value());
 			}
 
-			generator.outlineSize = sizeParams["outline"].number_value();
+			generator->outlineSize = sizeParams["outline"].number_value();
 
-			fonts[entry.first] = generator.GenerateFont(sizeParams["size"].int_value());
+			fonts[entry.first] = makeFont(entry.first, sizeParams["size"].int_value());
 		}
 	}
 
@@ -22,6 +22,7 @@
 //-----------------------------------------------------------------------------
 
 #include "lunatextureloader.h"
+#include "lunagraphics.h"
 
 using namespace luna2d;
 
@@ -43,6 +44,8 @@ bool LUNATextureLoader::Load(const std::string& filename)
 	LUNAImage image(filename, *format, LUNAFileLocation::ASSETS);
 	if(image.IsEmpty()) return false;
 
+	if(LUNAEngine::SharedGraphics()->GetRenderer()->IsPremultipliedAlpha()) image.PremultiplyAlpha();
+
 	// Make texture from image
 	texture = std::make_shared<LUNATexture>(image);
 
@@ -39,7 +39,6 @@
 #include "math/lunasplines.h"
 #include "math/lunaeasing.h"
 #include "math/lunabounds.h"
-#include "lunapngformat.h"
 
 using namespace luna2d;
 
@@ -77,16 +76,19 @@ static void BindUtils(LuaScript* lua, LuaTable& tblLuna)
 	tblLuna.SetField("utils", tblUtils);
 
 	// Take screenshot image to application folder
-	std::function<void(const std::string&)> fnTakeScreenshot = [](const std::string& filename)
+	// Image is saved asynchronously. Optional callback is called with success flag and filename when file is written
+	std::function<void(const std::string&, const LuaFunction&)> fnTakeScreenshot =
+		[](const std::string& filename, const LuaFunction& fnCallback)
 	{
 		// Take screenshot when current frame will be completely rendered
-		LUNAEngine::SharedGraphics()->RunAfterRender([filename]()
+		LUNAEngine::SharedGraphics()->RunAfterRender([filename, fnCallback]()
 		{
-			auto image = LUNAEngine::SharedGraphics()->GetRenderer()->ReadPixels();
-			image->Save(filename, LUNAPngFormat(), LUNAFileLocation::APP_FOLDER);
+			LUNAEngine::SharedGraphics()->GetScreenshots()->Take(filename, fnCallback);
 		});
 	};
 	tblUtils.SetField("takeScreenshot", LuaFunction(lua, fnTakeScreenshot));
+	tblUtils.SetField("getPendingScreenshots", LuaFunction(lua, LUNAEngine::SharedGraphics()->GetScreenshots(),
+		&LUNAScreenshots::GetPendingCount));
 
 	// Register "ChanceTable" class
 	lua->DoString(LUNA_CHANCE_TABLE);
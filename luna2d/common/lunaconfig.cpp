@@ -92,6 +92,15 @@ void LUNAConfig::ReadContentHeight(const json11::Json& jsonConfig)
 	else LUNA_LOGE("Content height must be number");
 }
 
+void LUNAConfig::ReadPremultipliedAlpha(const json11::Json& jsonConfig)
+{
+	auto jsonPremultiplied = jsonConfig["premultipliedAlpha"];
+	if(jsonPremultiplied.is_null()) return;
+
+	if(jsonPremultiplied.is_bool()) premultipliedAlpha = jsonPremultiplied.bool_value();
+	else LUNA_LOGE("Premultiplied alpha must be boolean");
+}
+
 void LUNAConfig::ReadDebugValues(const json11::Json& jsonConfig)
 {
 	debug_missedStrings = jsonConfig["debug_missedStrings"].bool_value();
@@ -142,6 +151,7 @@ bool LUNAConfig::Read()
 	ReadScaleMode(jsonConfig);
 	ReadContentWidth(jsonConfig);
 	ReadContentHeight(jsonConfig);
+	ReadPremultipliedAlpha(jsonConfig);
 	ReadDebugValues(jsonConfig);
 
 	customValues = jsonConfig;
@@ -65,6 +65,7 @@ public:
 	LUNAScaleMode scaleMode = LUNAScaleMode::ADAPTIVE;
 	int contentWidth = 480;
 	int contentHeight = 320;
+	bool premultipliedAlpha = false; // Use premultiplied alpha for textures and blending
 	bool debug_missedStrings = false;
 
 private:
@@ -76,6 +77,7 @@ private:
 	void ReadScaleMode(const json11::Json& jsonConfig);
 	void ReadContentWidth(const json11::Json& jsonConfig);
 	void ReadContentHeight(const json11::Json& jsonConfig);
+	void ReadPremultipliedAlpha(const json11::Json& jsonConfig);
 	void ReadDebugValues(const json11::Json& jsonConfig);
 
 public:
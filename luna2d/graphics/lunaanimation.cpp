@@ -128,9 +128,9 @@ void LUNAAnimation::Update(float deltaTime)
 	if(curFrame.expired()) LUNA_RETURN_ERR("Invalid frame in animation");
 
 	auto frameRegion = curFrame.lock();
-	material.texture = frameRegion->GetTexture();
-	u1 = frameRegion->GetU1();
-	v1 = frameRegion->GetV1();
-	u2 = frameRegion->GetU2();
-	v2 = frameRegion->GetV2();
+	uint32_t prevMaterial = material.GetHandle();
+	material.SetTexture(frameRegion->GetTexture());
+	if(material.GetHandle() != prevMaterial) version++;
+
+	SetUv(frameRegion->GetU1(), frameRegion->GetV1(), frameRegion->GetU2(), frameRegion->GetV2());
 }
@@ -33,6 +33,7 @@ enum class LUNABlendingMode
 	NONE,
 	ALPHA,
 	ADDITIVE,
+	PREMULTIPLIED, // Alpha blending for textures with colors already multiplied by alpha, e.g. rendered to frame buffer
 };
 
 const LUNAStringEnum<LUNABlendingMode> BLENDING_MODE =
@@ -40,6 +41,7 @@ const LUNAStringEnum<LUNABlendingMode> BLENDING_MODE =
 	"none",
 	"alpha",
 	"additive",
+	"premultiplied",
 };
 
 template<>
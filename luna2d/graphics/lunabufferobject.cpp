@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunabufferobject.h"
+#include "lunaglstate.h"
+
+using namespace luna2d;
+
+static GLenum ToGlTarget(LUNABufferType type)
+{
+	return type == LUNABufferType::INDEX ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+}
+
+static GLenum ToGlUsage(LUNABufferUsage usage)
+{
+	switch(usage)
+	{
+	case LUNABufferUsage::STATIC:
+		return GL_STATIC_DRAW;
+	case LUNABufferUsage::DYNAMIC:
+		return GL_DYNAMIC_DRAW;
+	case LUNABufferUsage::STREAM:
+		return GL_STREAM_DRAW;
+	}
+
+	return GL_STREAM_DRAW;
+}
+
+LUNABufferObject::LUNABufferObject(LUNABufferType type, LUNABufferUsage usage) :
+	target(ToGlTarget(type)),
+	usage(ToGlUsage(usage))
+{
+	glGenBuffers(1, &id);
+}
+
+LUNABufferObject::~LUNABufferObject()
+{
+	LUNAGlState::OnDeleteBuffer(id);
+	glDeleteBuffers(1, &id);
+}
+
+GLuint LUNABufferObject::GetId()
+{
+	return id;
+}
+
+size_t LUNABufferObject::GetCapacity()
+{
+	return capacity;
+}
+
+// Upload given data to buffer. Buffer should be bound
+// Previous buffer storage is orphaned, so driver don't wait while GPU finishes reading old data
+void LUNABufferObject::SetData(const void* data, size_t size)
+{
+	// Static data is rarely changed, so storage isn't grown in advance
+	if(size > capacity) capacity = usage == GL_STATIC_DRAW ? size : std::max(size, capacity * 2);
+
+	glBufferData(target, capacity, nullptr, usage);
+	glBufferSubData(target, 0, size, data);
+}
+
+void LUNABufferObject::Bind()
+{
+	LUNAGlState::BindBuffer(target, id);
+}
+
+void LUNABufferObject::Unbind()
+{
+	LUNAGlState::BindBuffer(target, 0);
+}
+
+// Recreate buffer when application lost OpenGL context
+// Buffer data should be uploaded again after recreating
+void LUNABufferObject::Reload()
+{
+	glGenBuffers(1, &id);
+	capacity = 0;
+}
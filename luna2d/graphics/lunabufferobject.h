@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunagl.h"
+#include "lunaglhelpers.h"
+#include "lunaengine.h"
+
+namespace luna2d{
+
+enum class LUNABufferType
+{
+	VERTEX,
+	INDEX
+};
+
+enum class LUNABufferUsage
+{
+	STATIC, // Data uploads once and uses many times
+	DYNAMIC, // Data modifies sometimes
+	STREAM // Data uploads every time before using
+};
+
+//----------------------------------
+// Wrapper for OpenGL buffer objects
+//----------------------------------
+class LUNABufferObject
+{
+public:
+	LUNABufferObject(LUNABufferType type, LUNABufferUsage usage);
+	~LUNABufferObject();
+
+private:
+	GLuint id = 0;
+	GLenum target;
+	GLenum usage;
+	size_t capacity = 0; // Size of allocated buffer storage (in bytes)
+
+public:
+	GLuint GetId();
+	size_t GetCapacity();
+
+	// Upload given data to buffer. Buffer should be bound
+	// Previous buffer storage is orphaned, so driver don't wait while GPU finishes reading old data
+	void SetData(const void* data, size_t size);
+
+	void Bind();
+	void Unbind();
+
+	// Recreate buffer when application lost OpenGL context
+	// Buffer data should be uploaded again after recreating
+	void Reload();
+};
+
+}
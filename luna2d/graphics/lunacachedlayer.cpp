@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunacachedlayer.h"
+#include "lunagraphics.h"
+#include "lunasizes.h"
+
+using namespace luna2d;
+
+LUNACachedLayer::LUNACachedLayer(const LuaFunction& fnRender) :
+	fnRender(fnRender)
+{
+	auto sizes = LUNAEngine::SharedSizes();
+	frameBuffer = std::make_shared<LUNAFrameBuffer>(sizes->GetPhysicalScreenWidth(), sizes->GetPhysicalScreenHeight(),
+		LUNAColorType::RGBA);
+	region = frameBuffer->GetTextureRegion();
+	sprite = std::unique_ptr<LUNASprite>(new LUNASprite(region));
+
+	// Content of frame buffer has colors multiplied by alpha
+	sprite->SetBlendingMode(LUNABlendingMode::PREMULTIPLIED);
+}
+
+void LUNACachedLayer::Redraw()
+{
+	if(!fnRender)
+	{
+		LUNA_LOGE("Render function for cached layer is not set");
+		return;
+	}
+
+	auto renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	auto prevFrameBuffer = renderer->GetFrameBuffer();
+
+	renderer->SetFrameBuffer(frameBuffer);
+	frameBuffer->Clear();
+	fnRender.CallVoid();
+	renderer->SetFrameBuffer(prevFrameBuffer);
+
+	viewRect = LUNAEngine::SharedGraphics()->GetCamera()->GetViewRect();
+	UpdateWatchedVersions();
+	dirty = false;
+}
+
+void LUNACachedLayer::UpdateWatchedVersions()
+{
+	for(auto& watched : watchedSprites)
+	{
+		if(!watched.object.expired()) watched.version = watched.object.lock()->GetVersion();
+	}
+
+	for(auto& watched : watchedTexts)
+	{
+		if(!watched.object.expired()) watched.version = watched.object.lock()->GetVersion();
+	}
+}
+
+void LUNACachedLayer::Invalidate()
+{
+	dirty = true;
+}
+
+bool LUNACachedLayer::IsDirty()
+{
+	if(dirty) return true;
+
+	// Removed object also changes content of layer
+	for(const auto& watched : watchedSprites)
+	{
+		if(watched.object.expired() || watched.object.lock()->GetVersion() != watched.version) return true;
+	}
+
+	for(const auto& watched : watchedTexts)
+	{
+		if(watched.object.expired() || watched.object.lock()->GetVersion() != watched.version) return true;
+	}
+
+	return false;
+}
+
+void LUNACachedLayer::Watch(const LuaAny& object)
+{
+	auto spriteObj = object.To<std::weak_ptr<LUNASprite>>();
+	if(!spriteObj.expired())
+	{
+		watchedSprites.push_back({ spriteObj, spriteObj.lock()->GetVersion() });
+		return;
+	}
+
+	auto textObj = object.To<std::weak_ptr<LUNAText>>();
+	if(!textObj.expired())
+	{
+		watchedTexts.push_back({ textObj, textObj.lock()->GetVersion() });
+		return;
+	}
+
+	LUNA_LOGE("Cached layer can watch only sprites and texts");
+}
+
+int LUNACachedLayer::GetHits()
+{
+	return hits;
+}
+
+int LUNACachedLayer::GetMisses()
+{
+	return misses;
+}
+
+void LUNACachedLayer::ResetCounters()
+{
+	hits = 0;
+	misses = 0;
+}
+
+void LUNACachedLayer::Render()
+{
+	if(IsDirty())
+	{
+		misses++;
+		Redraw();
+
+		// Expired objects are not needed after redraw
+		watchedSprites.erase(std::remove_if(watchedSprites.begin(), watchedSprites.end(),
+			[](const WatchedObject<LUNASprite>& watched) { return watched.object.expired(); }), watchedSprites.end());
+		watchedTexts.erase(std::remove_if(watchedTexts.begin(), watchedTexts.end(),
+			[](const WatchedObject<LUNAText>& watched) { return watched.object.expired(); }), watchedTexts.end());
+	}
+	else hits++;
+
+	// Composite cached texture as one quad covering camera view at moment of redraw
+	sprite->SetPos(viewRect.x, viewRect.y);
+	sprite->SetSize(viewRect.width, viewRect.height);
+	sprite->Render();
+}
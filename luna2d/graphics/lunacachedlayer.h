@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunaframebuffer.h"
+#include "lunasprite.h"
+#include "lunatext.h"
+
+namespace luna2d{
+
+//-------------------------------------------------------------------
+// Layer which caches result of render function in offscreen texture
+// Render function is called again only when layer was invalidated
+// or when any of watched objects was changed since last redraw.
+// Otherwise layer is rendered as one fullscreen quad
+//-------------------------------------------------------------------
+class LUNACachedLayer
+{
+	LUNA_USERDATA(LUNACachedLayer)
+
+public:
+	LUNACachedLayer(const LuaFunction& fnRender);
+
+private:
+	template<typename T>
+	struct WatchedObject
+	{
+		std::weak_ptr<T> object;
+		unsigned int version;
+	};
+
+private:
+	LuaFunction fnRender;
+	std::shared_ptr<LUNAFrameBuffer> frameBuffer;
+	std::shared_ptr<LUNATextureRegion> region;
+	std::unique_ptr<LUNASprite> sprite;
+	std::vector<WatchedObject<LUNASprite>> watchedSprites;
+	std::vector<WatchedObject<LUNAText>> watchedTexts;
+	LUNARect viewRect; // Camera view rect at moment of last redraw
+	bool dirty = true;
+	int hits = 0;
+	int misses = 0;
+
+private:
+	void Redraw();
+	void UpdateWatchedVersions();
+
+public:
+	void Invalidate();
+	bool IsDirty();
+
+	// Watch given sprite or text. Layer will be redrawn when any watched object is changed
+	void Watch(const LuaAny& object);
+
+	int GetHits(); // Get count of renders used cached texture
+	int GetMisses(); // Get count of renders called render function
+	void ResetCounters();
+	void Render();
+};
+
+}
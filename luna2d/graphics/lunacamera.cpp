@@ -27,6 +27,8 @@
 
 using namespace luna2d;
 
+unsigned int LUNACamera::lastMatrixVersion = 0;
+
 LUNACamera::LUNACamera(float width, int height) :
 	width(width),
 	height(height),
@@ -41,13 +43,18 @@ void LUNACamera::UpdateMatrix()
 	float halfHeight = (height * zoom) / 2.0f;
 
 	matrix = glm::ortho(pos.x - halfWidth, pos.x + halfWidth, pos.y - halfHeight, pos.y + halfHeight);
+	viewRect = LUNARect(pos.x - halfWidth, pos.y - halfHeight, halfWidth * 2.0f, halfHeight * 2.0f);
+
+	// Version 0 is reserved for matrixes without version
+	if(++lastMatrixVersion == 0) lastMatrixVersion++;
+	matrixVersion = lastMatrixVersion;
 }
 
 void LUNACamera::UpdateRender()
 {
 	// Make render call if camera has been changed during render
 	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
-	if(renderer && renderer->IsInProgress()) renderer->Render();
+	if(renderer && renderer->IsInProgress()) renderer->Render(LUNAFlushReason::CAMERA);
 }
 
 float LUNACamera::GetX()
@@ -103,6 +110,17 @@ const glm::mat4& LUNACamera::GetMatrix()
 	return matrix;
 }
 
+// Get version of matrix. Shaders use it to skip uploading of same matrix
+unsigned int LUNACamera::GetMatrixVersion()
+{
+	return matrixVersion;
+}
+
+const LUNARect& LUNACamera::GetViewRect()
+{
+	return viewRect;
+}
+
 // Convert coordinates from camera to physical screen
 glm::vec2 LUNACamera::Project(const glm::vec2& pos)
 {
@@ -25,6 +25,7 @@
 
 #include "lunaglm.h"
 #include "lunalua.h"
+#include "lunarect.h"
 
 namespace luna2d{
 
@@ -43,6 +44,10 @@ private:
 	float zoom;
 	glm::vec2 pos;
 	glm::mat4 matrix;
+	unsigned int matrixVersion = 0; // Unique among all cameras, changed on every update of matrix
+	LUNARect viewRect; // Area of world visible by camera
+
+	static unsigned int lastMatrixVersion;
 
 private:
 	void UpdateMatrix();
@@ -58,6 +63,8 @@ public:
 	float GetZoom();
 	void SetZoom(float zoom);
 	const glm::mat4& GetMatrix();
+	unsigned int GetMatrixVersion();
+	const LUNARect& GetViewRect();
 
 	// Convert coordinates from camera to physical screen
 	glm::vec2 Project(const glm::vec2& pos);
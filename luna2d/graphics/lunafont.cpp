@@ -23,6 +23,8 @@
 
 #include "lunafont.h"
 #include "lunautf.h"
+#include "lunaglyphatlas.h"
+#include "lunagraphics.h"
 
 using namespace luna2d;
 
@@ -33,6 +35,16 @@ LUNAFont::LUNAFont(const std::shared_ptr<LUNATexture>& texture, int size, int ou
 {
 }
 
+// Construct dynamic font. Glyphs are rasterized to atlas on first use
+LUNAFont::LUNAFont(const std::shared_ptr<LUNAGlyphAtlas>& atlas, int size, int outlineSize) :
+	texture(atlas->GetTexture()),
+	unknownChar(atlas->GetUnknownCharGlyph()),
+	size(size),
+	outlineSize(outlineSize),
+	atlas(atlas)
+{
+}
+
 std::weak_ptr<LUNATexture> LUNAFont::GetTexture()
 {
 	return texture;
@@ -41,7 +53,19 @@ std::weak_ptr<LUNATexture> LUNAFont::GetTexture()
  // Set texture region for given char
 void LUNAFont::SetGlyph(char32_t c, const LUNAGlyph& glyph)
 {
-	glyphs[c] = glyph;
+	size_t block = c / GLYPH_PAGE_SIZE;
+	if(block >= glyphPages.size()) glyphPages.resize(block + 1);
+	if(!glyphPages[block]) glyphPages[block] = std::unique_ptr<LUNAGlyphPage>(new LUNAGlyphPage());
+
+	size_t index = c % GLYPH_PAGE_SIZE;
+	glyphPages[block]->glyphs[index] = glyph;
+	glyphPages[block]->used.set(index);
+}
+
+void LUNAFont::RemoveGlyph(char32_t c)
+{
+	size_t block = c / GLYPH_PAGE_SIZE;
+	if(block < glyphPages.size() && glyphPages[block]) glyphPages[block]->used.reset(c % GLYPH_PAGE_SIZE);
 }
 
  // Set texture region for unknown char
@@ -52,8 +76,57 @@ void LUNAFont::SetUnknownCharGlyph(const LUNAGlyph& glyph)
 
 const LUNAGlyph& LUNAFont::GetGlyphForChar(char32_t c)
 {
-	if(glyphs.count(c) == 0) return unknownChar; // If char not found return unknown char glyph
-	return glyphs[c];
+	const LUNAGlyph* found = FindGlyph(c);
+	if(found)
+	{
+		if(atlas) atlas->TouchGlyph(c);
+		return *found;
+	}
+
+	if(!atlas) return unknownChar; // If char not found return unknown char glyph
+
+	// Rasterize missing char for dynamic font
+	LUNAGlyph glyph;
+	std::vector<char32_t> evicted;
+	if(!atlas->AddGlyph(c, glyph, evicted)) return unknownChar;
+
+	if(!evicted.empty())
+	{
+		for(char32_t evictedChar : evicted) RemoveGlyph(evictedChar);
+		glyphsVersion++;
+	}
+
+	SetGlyph(c, glyph);
+	return *FindGlyph(c);
+}
+
+// Set offset between given pair of chars
+void LUNAFont::SetKerning(char32_t left, char32_t right, float offset)
+{
+	kerning[((uint64_t)left << 32) | right] = offset;
+}
+
+// Get offset between given pair of chars
+float LUNAFont::GetKerning(char32_t left, char32_t right)
+{
+	if(kerning.empty() && !atlas) return 0;
+
+	uint64_t key = ((uint64_t)left << 32) | right;
+	auto it = kerning.find(key);
+	if(it != kerning.end()) return it->second;
+	if(!atlas) return 0;
+
+	// Kerning of dynamic font is got from FreeType on first use
+	float offset = atlas->GetKerning(left, right);
+	kerning[key] = offset;
+	return offset;
+}
+
+// Get height of one line of text
+float LUNAFont::GetLineHeight()
+{
+	// All glyphs have height of line, so use placeholder which always exists
+	return unknownChar.height;
 }
 
 int LUNAFont::GetSize()
@@ -66,12 +139,64 @@ int LUNAFont::GetOutlineSize()
 	return outlineSize;
 }
 
+bool LUNAFont::IsDynamic()
+{
+	return atlas != nullptr;
+}
+
+// Changed when glyphs of dynamic font were evicted from atlas or atlas was lost with GL context
+unsigned int LUNAFont::GetGlyphsVersion()
+{
+	if(atlas && atlas->CheckContext())
+	{
+		for(auto& page : glyphPages)
+		{
+			if(page) page->used.reset();
+		}
+		glyphsVersion++;
+	}
+
+	return glyphsVersion;
+}
+
+// Mark glyphs of dynamic font as used on current frame
+void LUNAFont::TouchGlyphs(const std::u32string& text)
+{
+	if(!atlas) return;
+
+	for(char32_t c : text) atlas->TouchGlyph(c);
+}
+
+// Make font rendered from distance field atlas with given shader
+void LUNAFont::SetDistanceField(const std::shared_ptr<LUNAShader>& shader)
+{
+	this->shader = shader;
+}
+
+bool LUNAFont::IsDistanceField()
+{
+	return shader != nullptr;
+}
+
+// Get shader for rendering text typed with this font
+std::weak_ptr<LUNAShader> LUNAFont::GetShader()
+{
+	if(shader) return shader;
+	return LUNAEngine::SharedGraphics()->GetRenderer()->GetFontShader();
+}
+
 // Get width of one-line string typed with this font
 float LUNAFont::GetStringWidth(const std::string& string)
 {
 	float width = 0.0f;
+	char32_t prev = 0;
 
-	for(auto c : utf::ToUtf32(string)) width += GetGlyphForChar(c).width;
+	for(auto c : utf::ToUtf32(string))
+	{
+		if(prev != 0) width += GetKerning(prev, c);
+		width += GetGlyphForChar(c).width;
+		prev = c;
+	}
 
 	return width;
 }
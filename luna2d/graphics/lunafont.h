@@ -24,23 +24,53 @@
 #pragma once
 
 #include "lunatextureregion.h"
+#include "lunashader.h"
+#include <bitset>
 
 namespace luna2d{
 
+const int GLYPH_PAGE_SIZE = 256; // Count of chars in one page of glyph table
+
+//-----------------------------------------------------------
+// Glyph of char. Texture coordinates and metrics are stored
+// inline, so glyphs can be kept in plain arrays
+//-----------------------------------------------------------
 struct LUNAGlyph
 {
-	LUNAGlyph(const std::shared_ptr<LUNATextureRegion>& region, float width, float height, float offsetX, float offsetY) :
-		region(region), width(width), height(height), offsetX(offsetX), offsetY(offsetY) {}
+	LUNAGlyph(float u1, float v1, float u2, float v2, float quadWidth, float quadHeight,
+		float width, float height, float offsetX, float offsetY) :
+		u1(u1), v1(v1), u2(u2), v2(v2), quadWidth(quadWidth), quadHeight(quadHeight),
+		width(width), height(height), offsetX(offsetX), offsetY(offsetY) {}
 
 	LUNAGlyph() {}
 
-	std::shared_ptr<LUNATextureRegion> region;
-	float width = 0.0f;
+	// Texture coordinates of glyph in font texture
+	float u1 = 0.0f;
+	float v1 = 0.0f;
+	float u2 = 0.0f;
+	float v2 = 0.0f;
+
+	// Sizes of glyph quad in points
+	float quadWidth = 0.0f;
+	float quadHeight = 0.0f;
+
+	float width = 0.0f; // Advance of pen to next glyph
 	float height = 0.0f;
 	float offsetX = 0.0f;
 	float offsetY = 0.0f;
 };
 
+//-----------------------------------------------------------
+// Glyphs for block of GLYPH_PAGE_SIZE consecutive chars
+//-----------------------------------------------------------
+struct LUNAGlyphPage
+{
+	LUNAGlyph glyphs[GLYPH_PAGE_SIZE];
+	std::bitset<GLYPH_PAGE_SIZE> used; // Flags of chars having glyph
+};
+
+
+class LUNAGlyphAtlas;
 
 class LUNAFont : public LUNAAsset
 {
@@ -49,12 +79,33 @@ class LUNAFont : public LUNAAsset
 public:
 	LUNAFont(const std::shared_ptr<LUNATexture>& texture, int size, int outlineSize);
 
+	// Construct dynamic font. Glyphs are rasterized to atlas on first use
+	LUNAFont(const std::shared_ptr<LUNAGlyphAtlas>& atlas, int size, int outlineSize);
+
 private:
 	std::shared_ptr<LUNATexture> texture;
-	std::unordered_map<char32_t, LUNAGlyph> glyphs;
+	std::vector<std::unique_ptr<LUNAGlyphPage>> glyphPages; // Indexed by block of char. Blocks without glyphs have no page
+	std::unordered_map<uint64_t, float> kerning; // Offsets for pairs of chars. Key is left char in high half and right char in low half
 	LUNAGlyph unknownChar;
 	int size;
 	int outlineSize;
+	std::shared_ptr<LUNAGlyphAtlas> atlas; // Only for dynamic fonts
+	unsigned int glyphsVersion = 0; // Changed when glyphs of dynamic font were evicted from atlas or atlas was lost with GL context
+	std::shared_ptr<LUNAShader> shader; // Only for distance field fonts
+
+private:
+	// Find glyph in glyph table. Returns nullptr if font has no glyph for given char
+	inline const LUNAGlyph* FindGlyph(char32_t c) const
+	{
+		size_t block = c / GLYPH_PAGE_SIZE;
+		if(block >= glyphPages.size() || !glyphPages[block]) return nullptr;
+
+		const LUNAGlyphPage& page = *glyphPages[block];
+		size_t index = c % GLYPH_PAGE_SIZE;
+		return page.used[index] ? &page.glyphs[index] : nullptr;
+	}
+
+	void RemoveGlyph(char32_t c);
 
 public:
 	std::weak_ptr<LUNATexture> GetTexture();
@@ -63,9 +114,21 @@ public:
 	void SetUnknownCharGlyph(const LUNAGlyph& glyph); // Set texture region for unknown char
 
 	const LUNAGlyph& GetGlyphForChar(char32_t c);
+	void SetKerning(char32_t left, char32_t right, float offset); // Set offset between given pair of chars
+	float GetKerning(char32_t left, char32_t right); // Get offset between given pair of chars
+	float GetLineHeight(); // Get height of one line of text
 	int GetSize();
 	int GetOutlineSize();
 
+	bool IsDynamic();
+	unsigned int GetGlyphsVersion(); // Changed when glyphs of dynamic font were evicted from atlas or atlas was lost with GL context
+	void TouchGlyphs(const std::u32string& text); // Mark glyphs of dynamic font as used on current frame
+
+	// Make font rendered from distance field atlas with given shader
+	void SetDistanceField(const std::shared_ptr<LUNAShader>& shader);
+	bool IsDistanceField();
+	std::weak_ptr<LUNAShader> GetShader(); // Get shader for rendering text typed with this font
+
 	float GetStringWidth(const std::string& string); // Get width of one-line string typed with this font
 	float GetStringHeight(const std::string& string); // Get height of one-line string typed with this font
 };
@@ -0,0 +1,229 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunafontcache.h"
+#include "lunasizes.h"
+#include "lunafiles.h"
+#include <cstring>
+
+using namespace luna2d;
+
+const uint32_t FONT_CACHE_MAGIC = 0x4346464C; // "LFFC"
+const size_t FONT_CACHE_CHAR_SIZE = sizeof(uint32_t) + 4 * sizeof(int) + 4 * sizeof(float); // Size of char written by "WriteChar"
+const size_t FONT_CACHE_KERNING_SIZE = 2 * sizeof(uint32_t) + sizeof(float); // Size of one kerning pair
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// FNV-1a hash of given data
+static uint64_t HashData(const unsigned char* data, size_t size, uint64_t hash = FNV_OFFSET)
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static std::string HashToString(uint64_t hash)
+{
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+	return buf;
+}
+
+template<typename T>
+static void WriteValue(std::vector<unsigned char>& data, const T& value)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static bool ReadValue(const std::vector<unsigned char>& data, size_t& pos, T& outValue)
+{
+	if(pos + sizeof(T) > data.size()) return false;
+
+	std::memcpy(&outValue, &data[pos], sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+static void WriteChar(std::vector<unsigned char>& data, const LUNABakedFont::Char& bakedChar)
+{
+	WriteValue(data, (uint32_t)bakedChar.c);
+	WriteValue(data, bakedChar.regionX);
+	WriteValue(data, bakedChar.regionY);
+	WriteValue(data, bakedChar.regionWidth);
+	WriteValue(data, bakedChar.regionHeight);
+	WriteValue(data, bakedChar.charWidth);
+	WriteValue(data, bakedChar.charHeight);
+	WriteValue(data, bakedChar.charOffsetX);
+	WriteValue(data, bakedChar.charOffsetY);
+}
+
+static bool ReadChar(const std::vector<unsigned char>& data, size_t& pos, LUNABakedFont::Char& outChar)
+{
+	uint32_t c = 0;
+	if(!ReadValue(data, pos, c)) return false;
+	outChar.c = (char32_t)c;
+
+	return ReadValue(data, pos, outChar.regionX) && ReadValue(data, pos, outChar.regionY) &&
+		ReadValue(data, pos, outChar.regionWidth) && ReadValue(data, pos, outChar.regionHeight) &&
+		ReadValue(data, pos, outChar.charWidth) && ReadValue(data, pos, outChar.charHeight) &&
+		ReadValue(data, pos, outChar.charOffsetX) && ReadValue(data, pos, outChar.charOffsetY);
+}
+
+LUNAFontCache::LUNAFontCache(const std::vector<unsigned char>& fontData) :
+	fontHash(fontData.empty() ? 0 : HashData(&fontData[0], fontData.size()))
+{
+}
+
+// Make key from all parameters which affect baked font
+std::string LUNAFontCache::MakeKey(const LUNAFontGenerator& generator, int size)
+{
+	std::string charSets;
+	if(generator.enableLatin) charSets += "l";
+	if(generator.enableDiactritic) charSets += "d";
+	if(generator.enableCyrillic) charSets += "c";
+	if(generator.enableCommon) charSets += "s";
+	if(generator.enableNumbers) charSets += "n";
+
+	uint64_t customHash = HashData(reinterpret_cast<const unsigned char*>(generator.customSymbols.data()),
+		generator.customSymbols.size() * sizeof(char32_t));
+
+	return HashToString(fontHash) +
+		"|size=" + std::to_string(size) +
+		"|outline=" + std::to_string(generator.outlineSize) +
+		"|sdf=" + std::to_string(generator.sdfSpread) +
+		"|scale=" + std::to_string(LUNAEngine::SharedSizes()->GetTextureScale()) +
+		"|chars=" + charSets +
+		"|custom=" + HashToString(customHash);
+}
+
+// Get path of cache file for given key
+std::string LUNAFontCache::GetCachePath(const std::string& key)
+{
+	return "font_" + HashToString(HashData(reinterpret_cast<const unsigned char*>(key.data()), key.size())) + ".cache";
+}
+
+// Load baked font for given generator parameters and size
+// Returns false if cache doesn't contain such font. "outBakeTime" is time of baking font in seconds
+bool LUNAFontCache::Read(const LUNAFontGenerator& generator, int size, LUNABakedFont& outFont, float& outBakeTime)
+{
+	LUNAFiles* files = LUNAEngine::SharedFiles();
+
+	std::string key = MakeKey(generator, size);
+	std::string path = GetCachePath(key);
+	if(!files->IsFile(path, LUNAFileLocation::CACHE)) return false;
+
+	std::vector<unsigned char> data = files->ReadCompressedFile(path, LUNAFileLocation::CACHE);
+	size_t pos = 0;
+
+	// Check header. Key is stored in file to detect collisions of path hashes
+	uint32_t magic = 0, version = 0, keyLength = 0;
+	if(!ReadValue(data, pos, magic) || !ReadValue(data, pos, version) || !ReadValue(data, pos, keyLength)) return false;
+	if(magic != FONT_CACHE_MAGIC || version != FONT_CACHE_VERSION || keyLength != key.size()) return false;
+	if(pos + keyLength > data.size()) return false;
+	if(key.compare(0, std::string::npos, reinterpret_cast<const char*>(&data[pos]), keyLength) != 0) return false;
+	pos += keyLength;
+
+	int32_t width = 0, height = 0;
+	uint32_t charsCount = 0;
+	if(!ReadValue(data, pos, outBakeTime) || !ReadValue(data, pos, outFont.size) ||
+		!ReadValue(data, pos, outFont.outlineSize) || !ReadValue(data, pos, outFont.sdfSpread) ||
+		!ReadValue(data, pos, width) || !ReadValue(data, pos, height) ||
+		!ReadChar(data, pos, outFont.unknownChar) || !ReadValue(data, pos, charsCount)) return false;
+
+	// Counts are checked before allocating, so corrupted file cannot request huge arrays
+	if(charsCount > (data.size() - pos) / FONT_CACHE_CHAR_SIZE) return false;
+
+	outFont.chars.resize(charsCount);
+	for(auto& bakedChar : outFont.chars)
+	{
+		if(!ReadChar(data, pos, bakedChar)) return false;
+	}
+
+	uint32_t kerningCount = 0;
+	if(!ReadValue(data, pos, kerningCount)) return false;
+	if(kerningCount > (data.size() - pos) / FONT_CACHE_KERNING_SIZE) return false;
+
+	outFont.kerning.clear();
+	outFont.kerning.reserve(kerningCount);
+	for(uint32_t i = 0; i < kerningCount; i++)
+	{
+		uint32_t left = 0, right = 0;
+		float offset = 0;
+		if(!ReadValue(data, pos, left) || !ReadValue(data, pos, right) || !ReadValue(data, pos, offset)) return false;
+		outFont.kerning.push_back(LUNABakedFont::KerningPair((char32_t)left, (char32_t)right, offset));
+	}
+
+	// Atlas image is stored last
+	size_t imageSize = width * height * GetBytesPerPixel(LUNAColorType::ALPHA);
+	if(width <= 0 || height <= 0 || data.size() - pos != imageSize) return false;
+
+	std::vector<unsigned char> imageData(data.begin() + pos, data.end());
+	outFont.image = std::make_shared<LUNAImage>(width, height, LUNAColorType::ALPHA, std::move(imageData));
+
+	return true;
+}
+
+// Save baked font for given generator parameters. "bakeTime" is time of baking font in seconds
+void LUNAFontCache::Write(const LUNAFontGenerator& generator, const LUNABakedFont& font, float bakeTime)
+{
+	if(!font.image || font.image->GetColorType() != LUNAColorType::ALPHA) return;
+
+	std::string key = MakeKey(generator, font.size);
+	std::vector<unsigned char> data;
+
+	WriteValue(data, FONT_CACHE_MAGIC);
+	WriteValue(data, FONT_CACHE_VERSION);
+	WriteValue(data, (uint32_t)key.size());
+	data.insert(data.end(), key.begin(), key.end());
+
+	WriteValue(data, bakeTime);
+	WriteValue(data, font.size);
+	WriteValue(data, font.outlineSize);
+	WriteValue(data, font.sdfSpread);
+	WriteValue(data, (int32_t)font.image->GetWidth());
+	WriteValue(data, (int32_t)font.image->GetHeight());
+	WriteChar(data, font.unknownChar);
+	WriteValue(data, (uint32_t)font.chars.size());
+	for(const auto& bakedChar : font.chars) WriteChar(data, bakedChar);
+	WriteValue(data, (uint32_t)font.kerning.size());
+	for(const auto& pair : font.kerning)
+	{
+		WriteValue(data, (uint32_t)pair.left);
+		WriteValue(data, (uint32_t)pair.right);
+		WriteValue(data, pair.offset);
+	}
+
+	const auto& imageData = font.image->GetData();
+	data.insert(data.end(), imageData.begin(), imageData.end());
+
+	if(!LUNAEngine::SharedFiles()->WriteCompressedFile(GetCachePath(key), data, LUNAFileLocation::CACHE))
+	{
+		LUNA_LOGW("Cannot write font cache file \"%s\"", GetCachePath(key).c_str());
+	}
+}
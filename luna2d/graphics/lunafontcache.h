@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunafontgenerator.h"
+
+namespace luna2d{
+
+const uint32_t FONT_CACHE_VERSION = 3; // Should be incremented on every change of cache file format
+
+//-------------------------------------------------------------------
+// Cache of baked fonts in "CACHE" location
+// Cache entry is keyed by hash of font file, font size, outline size,
+// distance field spread, texture scale and enabled char sets, so
+// changing any of them bakes font again. Hit is loaded without FreeType
+//-------------------------------------------------------------------
+class LUNAFontCache
+{
+public:
+	LUNAFontCache(const std::vector<unsigned char>& fontData);
+
+private:
+	uint64_t fontHash; // Hash of font file
+
+private:
+	// Make key from all parameters which affect baked font
+	std::string MakeKey(const LUNAFontGenerator& generator, int size);
+
+	// Get path of cache file for given key
+	std::string GetCachePath(const std::string& key);
+
+public:
+	// Load baked font for given generator parameters and size
+	// Returns false if cache doesn't contain such font. "outBakeTime" is time of baking font in seconds
+	bool Read(const LUNAFontGenerator& generator, int size, LUNABakedFont& outFont, float& outBakeTime);
+
+	// Save baked font for given generator parameters. "bakeTime" is time of baking font in seconds
+	void Write(const LUNAFontGenerator& generator, const LUNABakedFont& font, float bakeTime);
+};
+
+}
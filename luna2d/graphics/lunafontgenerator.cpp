@@ -24,6 +24,7 @@
 #include "lunafontgenerator.h"
 #include "lunasizes.h"
 #include "lunamath.h"
+#include "lunagraphics.h"
 
 using namespace luna2d;
 
@@ -33,31 +34,171 @@ const std::u32string CYRILLIC_CHARS = LUNA_UTF32("йцукенгшщзхъфыв
 const std::u32string COMMON_CHARS = LUNA_UTF32(" !@#$%^&*()-+=!№?¿<>[]{}:;,.\\/|`~'\"_©");
 const std::u32string NUMBER_CHARS = LUNA_UTF32("1234567890");
 
-struct CharRegion
+const float EDT_INF = 1e20f;
+
+// One-dimensional squared euclidean distance transform of sampled function
+// SEE: "Distance Transforms of Sampled Functions" by P. Felzenszwalb and D. Huttenlocher
+static void DistanceTransform1D(const float* f, float* d, int* v, float* z, int n)
 {
-	CharRegion(char32_t c, int regionX, int regionY, int regionWidth, int regionHeight,
-		float charWidth, float charHeight, float charOffsetX, float charOffsetY): c(c),
-		regionX(regionX), regionY(regionY), regionWidth(regionWidth), regionHeight(regionHeight),
-		charWidth(charWidth), charHeight(charHeight), charOffsetX(charOffsetX), charOffsetY(charOffsetY) {}
+	int k = 0;
+	v[0] = 0;
+	z[0] = -EDT_INF;
+	z[1] = EDT_INF;
+
+	for(int q = 1; q < n; q++)
+	{
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		while(s <= z[k])
+		{
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		}
+
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = EDT_INF;
+	}
+
+	k = 0;
+	for(int q = 0; q < n; q++)
+	{
+		while(z[k + 1] < q) k++;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
 
-	char32_t c = '\0';
-	int regionX;
-	int regionY;
-	int regionWidth;
-	int regionHeight;
-	float charWidth;
-	float charHeight;
-	float charOffsetX;
-	float charOffsetY;
+// Two-dimensional squared distance transform. Grid cells should be 0 for sources and EDT_INF for others
+static void DistanceTransform(std::vector<float>& grid, int width, int height)
+{
+	int n = std::max(width, height);
+	std::vector<float> f(n), d(n), z(n + 1);
+	std::vector<int> v(n);
 
-	LUNAGlyph ToGlyph(const std::shared_ptr<LUNATexture>& texture)
+	// Transform columns
+	for(int x = 0; x < width; x++)
 	{
-		float textureScale = LUNAEngine::SharedSizes()->GetTextureScale();
+		for(int y = 0; y < height; y++) f[y] = grid[y * width + x];
+		DistanceTransform1D(&f[0], &d[0], &v[0], &z[0], height);
+		for(int y = 0; y < height; y++) grid[y * width + x] = d[y];
+	}
 
-		return LUNAGlyph(std::make_shared<LUNATextureRegion>(texture, regionX, regionY, regionWidth, regionHeight),
-			charWidth * textureScale, charHeight * textureScale, charOffsetX * textureScale, charOffsetY * textureScale);
+	// Transform rows
+	for(int y = 0; y < height; y++)
+	{
+		std::copy(grid.begin() + y * width, grid.begin() + (y + 1) * width, f.begin());
+		DistanceTransform1D(&f[0], &d[0], &v[0], &z[0], width);
+		std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
 	}
-};
+}
+
+// Convert glyph bitmap to distance field with given spread on each side
+// Edge of glyph has value 0.5(128), inside values are greater
+static void MakeDistanceField(const std::vector<unsigned char>& bitmap, int width, int height, int spread,
+	std::vector<unsigned char>& outField)
+{
+	int fieldWidth = width + spread * 2;
+	int fieldHeight = height + spread * 2;
+	std::vector<float> toInside(fieldWidth * fieldHeight, EDT_INF); // Distances from outside pixels to glyph
+	std::vector<float> toOutside(fieldWidth * fieldHeight, EDT_INF); // Distances from glyph pixels to outside
+
+	for(int y = 0; y < fieldHeight; y++)
+	{
+		for(int x = 0; x < fieldWidth; x++)
+		{
+			int bitmapX = x - spread;
+			int bitmapY = y - spread;
+			bool inside = bitmapX >= 0 && bitmapY >= 0 && bitmapX < width && bitmapY < height &&
+				bitmap[bitmapY * width + bitmapX] >= 128;
+
+			if(inside) toInside[y * fieldWidth + x] = 0;
+			else toOutside[y * fieldWidth + x] = 0;
+		}
+	}
+
+	DistanceTransform(toInside, fieldWidth, fieldHeight);
+	DistanceTransform(toOutside, fieldWidth, fieldHeight);
+
+	outField.resize(fieldWidth * fieldHeight);
+	for(size_t i = 0; i < outField.size(); i++)
+	{
+		float distance = std::sqrt(toOutside[i]) - std::sqrt(toInside[i]); // Positive inside of glyph
+		float value = std::min(std::max(0.5f + distance / (spread * 2.0f), 0.0f), 1.0f);
+		outField[i] = (unsigned char)(value * 255.0f + 0.5f);
+	}
+}
+
+// Make glyph for char region in given texture. Metrics are multiplied by "scale"
+LUNAGlyph LUNABakedFont::Char::ToGlyph(const std::shared_ptr<LUNATexture>& texture, float scale) const
+{
+	float textureScale = LUNAEngine::SharedSizes()->GetTextureScale() * scale;
+	float textureWidth = texture->GetWidth();
+	float textureHeight = texture->GetHeight();
+
+	return LUNAGlyph(regionX / textureWidth, regionY / textureHeight,
+		(regionX + regionWidth) / textureWidth, (regionY + regionHeight) / textureHeight,
+		regionWidth * textureScale, regionHeight * textureScale, charWidth * textureScale,
+		charHeight * textureScale, charOffsetX * textureScale, charOffsetY * textureScale);
+}
+
+// Create texture from atlas image
+std::shared_ptr<LUNATexture> LUNABakedFont::MakeTexture() const
+{
+	if(!image || image->IsEmpty()) return nullptr;
+
+	// Create texture from generated image
+	auto texture = std::make_shared<LUNATexture>(*image);
+
+#if LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
+	// Cache generated texture to APP_DATA folder for reloading when lossing GL context
+	texture->Cache(image->GetData());
+#endif
+
+	return texture;
+}
+
+// Create texture from atlas image and make font from it
+std::shared_ptr<LUNAFont> LUNABakedFont::MakeFont() const
+{
+	auto texture = MakeTexture();
+	if(!texture) return nullptr;
+
+	// Create font
+	auto font = std::make_shared<LUNAFont>(texture, size, outlineSize);
+
+	// Set texture regions for chars
+	for(const auto& bakedChar : chars) font->SetGlyph(bakedChar.c, bakedChar.ToGlyph(texture));
+	font->SetUnknownCharGlyph(unknownChar.ToGlyph(texture));
+
+	float textureScale = LUNAEngine::SharedSizes()->GetTextureScale();
+	for(const auto& pair : kerning) font->SetKerning(pair.left, pair.right, pair.offset * textureScale);
+
+	return font;
+}
+
+// Make font with given size from distance field atlas. Fonts of all sizes can share one texture
+std::shared_ptr<LUNAFont> LUNABakedFont::MakeSdfFont(const std::shared_ptr<LUNATexture>& texture, int size, float outlineSize) const
+{
+	if(!texture || sdfSpread <= 0) return nullptr;
+
+	float scale = size / (float)this->size;
+
+	// Outline is rendered by lowering of edge threshold
+	float outlinePixels = outlineSize / LUNAEngine::SharedSizes()->GetTextureScale() / scale;
+	float threshold = std::min(std::max(0.5f - outlinePixels / (sdfSpread * 2.0f), 0.0f), 0.5f);
+	auto shader = LUNAEngine::SharedGraphics()->GetRenderer()->GetSdfFontShader(threshold);
+
+	auto font = std::make_shared<LUNAFont>(texture, size, outlineSize);
+	font->SetDistanceField(shader);
+
+	for(const auto& bakedChar : chars) font->SetGlyph(bakedChar.c, bakedChar.ToGlyph(texture, scale));
+	font->SetUnknownCharGlyph(unknownChar.ToGlyph(texture, scale));
+
+	float textureScale = LUNAEngine::SharedSizes()->GetTextureScale() * scale;
+	for(const auto& pair : kerning) font->SetKerning(pair.left, pair.right, pair.offset * textureScale);
+
+	return font;
+}
 
 LUNAFontGenerator::~LUNAFontGenerator()
 {
@@ -85,6 +226,7 @@ void LUNAFontGenerator::ResetCharSets()
 	enableNumbers = true;
 	customSymbols.clear();
 	outlineSize = 0;
+	sdfSpread = 0;
 }
 
 bool LUNAFontGenerator::Load(const std::string& filename, LUNAFileLocation location)
@@ -104,15 +246,96 @@ bool LUNAFontGenerator::Load(const std::string& filename, LUNAFileLocation locat
 	return true;
 }
 
-std::shared_ptr<LUNAFont> LUNAFontGenerator::GenerateFont(int size)
+void LUNAFontGenerator::SetCharSize(int size)
 {
-	if(!face) return nullptr;
+	if(size == charSize) return;
 
 	// For same font size on all resolutions size
 	// scale font size to virtual screen resolution and sets default DPI
 	int fontSize = std::floor(size / LUNAEngine::SharedSizes()->GetTextureScale());
 	FT_Set_Char_Size(face, PixelsToUnits(fontSize), 0, 0, 0);
 
+	charSize = size;
+}
+
+// Rasterize one char with current char size. Bitmap has sizes of char region and ALPHA color type
+bool LUNAFontGenerator::RasterizeChar(char32_t c, int outlineSizePixels, LUNABakedFont::Char& outChar, std::vector<unsigned char>& outBitmap)
+{
+	bool enableOutline = outlineSizePixels > 0;
+
+	FT_Error error = FT_Load_Char(face, c, enableOutline ? FT_LOAD_DEFAULT : FT_LOAD_RENDER);
+	if(error) return false;
+
+	FT_Stroker stroker = nullptr;
+	FT_Glyph glyph = nullptr;
+	FT_Bitmap bmp;
+
+	if(enableOutline)
+	{
+		FT_Stroker_New(library, &stroker);
+		FT_Stroker_Set(stroker, PixelsToUnits(outlineSizePixels), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+		FT_Get_Glyph(face->glyph, &glyph);
+		FT_Glyph_StrokeBorder(&glyph, stroker, false, true);
+		FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, true);
+		bmp = reinterpret_cast<FT_BitmapGlyph>(glyph)->bitmap;
+	}
+	else
+	{
+		bmp = face->glyph->bitmap;
+	}
+
+	bool success = bmp.pixel_mode == FT_PIXEL_MODE_GRAY;
+	if(success)
+	{
+		// Copy bitmap rows without pitch alignment
+		int width = bmp.width;
+		int height = bmp.rows;
+		outBitmap.resize(width * height);
+		for(int i = 0; i < height; i++) std::copy(bmp.buffer + i * bmp.pitch, bmp.buffer + i * bmp.pitch + width, outBitmap.begin() + i * width);
+
+		// SEE: https://www.freetype.org/freetype2/docs/glyphs/glyphs-3.html
+
+		int maxH = UnitsToPixels(face->size->metrics.height); // Max char height
+		int baseline = std::fabs((float)UnitsToPixels(face->size->metrics.descender)); // Distance from bottom to baseline
+
+		outChar.c = c;
+		outChar.regionWidth = width;
+		outChar.regionHeight = height;
+		outChar.charWidth = UnitsToPixels(face->glyph->advance.x);
+		outChar.charHeight = maxH;
+		outChar.charOffsetX = UnitsToPixels(face->glyph->metrics.horiBearingX) - outlineSizePixels;
+		outChar.charOffsetY = baseline + UnitsToPixels(face->glyph->metrics.horiBearingY - face->glyph->metrics.height) - outlineSizePixels;
+	}
+	else LUNA_LOGE("Supported only FT_PIXEL_MODE_GRAY");
+
+	if(enableOutline)
+	{
+		FT_Stroker_Done(stroker);
+		FT_Done_Glyph(glyph);
+	}
+
+	return success;
+}
+
+// Get kerning offset between given chars with current char size
+float LUNAFontGenerator::GetKerningPixels(char32_t left, char32_t right)
+{
+	if(!FT_HAS_KERNING(face)) return 0;
+
+	FT_Vector delta;
+	FT_Error error = FT_Get_Kerning(face, FT_Get_Char_Index(face, left), FT_Get_Char_Index(face, right), FT_KERNING_DEFAULT, &delta);
+	if(error) return 0;
+
+	return delta.x / 64.0f;
+}
+
+// Rasterize chars with given size into atlas image
+bool LUNAFontGenerator::BakeFont(int size, LUNABakedFont& outFont)
+{
+	if(!face) return false;
+
+	SetCharSize(size);
+
 	// Select available chars
 	std::u32string chars;
 
@@ -122,117 +345,145 @@ std::shared_ptr<LUNAFont> LUNAFontGenerator::GenerateFont(int size)
 	if(enableCommon) chars += COMMON_CHARS;
 	if(enableNumbers) chars += NUMBER_CHARS;
 	if(!customSymbols.empty()) chars += customSymbols;
-	int outlineSizePixels = std::floor(outlineSize / LUNAEngine::SharedSizes()->GetTextureScale());
-	bool enableOutline = outlineSizePixels > 0;
+
+	// Outline of distance field fonts is made by shader
+	bool sdf = sdfSpread > 0;
+	int outlineSizePixels = sdf ? 0 : std::floor(outlineSize / LUNAEngine::SharedSizes()->GetTextureScale());
 
 	// Get global char metrics
 	int maxW = UnitsToPixels(face->size->metrics.max_advance); // Max char width
 	int maxH = UnitsToPixels(face->size->metrics.height); // Max char height
-	int baseline = std::fabs((float)UnitsToPixels(face->size->metrics.descender)); // Distance from bottom to baseline
+
+	// Distance field is bigger than glyph bitmap by spread on each side
+	int cellW = sdf ? maxW + sdfSpread * 2 : maxW;
+	int cellH = sdf ? maxH + sdfSpread * 2 : maxH;
 
 	// Calculate texture size
-	int charArea = (maxW + CHAR_PADDING) * (maxH + CHAR_PADDING);
+	int charArea = (cellW + CHAR_PADDING) * (cellH + CHAR_PADDING);
 	int totalArea = (chars.size() + 1 /* + unknown char */) * charArea;
 	int textureSide = math::NearestPowerOfTwo(std::ceil(std::sqrt(totalArea)));
 
-	LUNAImage image(textureSide, textureSide, LUNAColorType::ALPHA);
+	auto image = std::make_shared<LUNAImage>(textureSide, textureSide, LUNAColorType::ALPHA);
 
 	// Fill image with white transparent color to avoid black artefacts around chars
-	image.Fill(LUNAColor::Rgb(255, 255, 255, 0));
+	image->Fill(LUNAColor::Rgb(255, 255, 255, 0));
 
 	// Draw placeholder for unknown char
-	image.FillRectangle(0, 0, maxW - 1, maxH, LUNAColor::WHITE);
-	CharRegion unknownChar('\0', 0, 0, maxW, maxH, maxW, maxH, 0.0f, 0.0f);
+	image->FillRectangle(0, 0, maxW - 1, maxH, LUNAColor::WHITE);
+	LUNABakedFont::Char unknownChar('\0', 0, 0, maxW, maxH, maxW, maxH, 0.0f, 0.0f);
 
-	std::vector<CharRegion> charRegions;
+	std::vector<LUNABakedFont::Char> charRegions;
+	std::vector<unsigned char> bitmap;
+	std::vector<unsigned char> field;
 	int penX = maxW;
 	int penY = 0;
 
 	// Draw chars on image
 	for(char32_t c : chars)
 	{
-		FT_Error error = FT_Load_Char(face, c, enableOutline ? FT_LOAD_DEFAULT : FT_LOAD_RENDER);
-		if(error) continue;
-
-		FT_Stroker stroker;
-		FT_Glyph glyph;
-		FT_Bitmap bmp;
+		LUNABakedFont::Char bakedChar;
+		if(!RasterizeChar(c, outlineSizePixels, bakedChar, bitmap)) continue;
 
-		if(enableOutline)
-		{
-			FT_Stroker_New(library, &stroker);
-			FT_Stroker_Set(stroker, PixelsToUnits(outlineSizePixels), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
-			FT_Get_Glyph(face->glyph, &glyph);
-			FT_Glyph_StrokeBorder(&glyph, stroker, false, true);
-			FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, true);
-			bmp = reinterpret_cast<FT_BitmapGlyph>(glyph)->bitmap;
-		}
-		else
+		if(sdf && !bitmap.empty())
 		{
-			bmp = face->glyph->bitmap;
-		}
+			MakeDistanceField(bitmap, bakedChar.regionWidth, bakedChar.regionHeight, sdfSpread, field);
+			bitmap.swap(field);
 
-		if(bmp.pixel_mode != FT_PIXEL_MODE_GRAY)
-		{
-			LUNA_LOGE("Supported only FT_PIXEL_MODE_GRAY");
-			continue;
+			bakedChar.regionWidth += sdfSpread * 2;
+			bakedChar.regionHeight += sdfSpread * 2;
+			bakedChar.charOffsetX -= sdfSpread;
+			bakedChar.charOffsetY -= sdfSpread;
 		}
 
 		// Move pen to next line
-		if(penX + maxW > image.GetWidth())
+		if(penX + cellW > image->GetWidth())
 		{
-			penY += maxH + CHAR_PADDING;
+			penY += cellH + CHAR_PADDING;
 			penX = 0;
 		}
 
-		int regionX = penX;
-		int regionY = penY;
-		int regionWidth = bmp.width;
-		int regionHeight = bmp.rows;
+		bakedChar.regionX = penX;
+		bakedChar.regionY = penY;
 
 		// Draw char bimtap to image
-		image.DrawRawBuffer(regionX, regionY, bmp.buffer, regionWidth, regionHeight, LUNAColorType::ALPHA);
-
-		// SEE: https://www.freetype.org/freetype2/docs/glyphs/glyphs-3.html
+		if(!bitmap.empty())
+		{
+			image->DrawRawBuffer(penX, penY, &bitmap[0], bakedChar.regionWidth, bakedChar.regionHeight, LUNAColorType::ALPHA);
+		}
 
-		int charWidth = UnitsToPixels(face->glyph->advance.x);
-		int charHeight = maxH;
-		int charOffsetX = UnitsToPixels(face->glyph->metrics.horiBearingX) - outlineSizePixels;
-		int charOffsetY = baseline + UnitsToPixels(face->glyph->metrics.horiBearingY - face->glyph->metrics.height) - outlineSizePixels;
+		charRegions.push_back(bakedChar);
 
-		charRegions.push_back(CharRegion(c, regionX, regionY, regionWidth, regionHeight,
-			charWidth, charHeight, charOffsetX, charOffsetY));
+		penX += bakedChar.regionWidth + CHAR_PADDING;
+	}
 
-		penX += regionWidth + CHAR_PADDING;
+	if(image->IsEmpty()) return false;
 
-		if(enableOutline)
+	// Capture kerning for all pairs of baked chars
+	std::vector<LUNABakedFont::KerningPair> kerning;
+	if(FT_HAS_KERNING(face))
+	{
+		for(const auto& left : charRegions)
 		{
-			FT_Stroker_Done(stroker);
-			FT_Done_Glyph(glyph);
+			for(const auto& right : charRegions)
+			{
+				float offset = GetKerningPixels(left.c, right.c);
+				if(offset != 0) kerning.push_back(LUNABakedFont::KerningPair(left.c, right.c, offset));
+			}
 		}
 	}
 
-	if(image.IsEmpty()) return nullptr;
-
 	// Crop empty space in texture if possible
-	int croppedHeight = math::NearestPowerOfTwo(penY + maxH);
-	if(croppedHeight < image.GetHeight()) image.SetSize(image.GetWidth(), croppedHeight);
+	int croppedHeight = math::NearestPowerOfTwo(penY + cellH);
+	if(croppedHeight < image->GetHeight()) image->SetSize(image->GetWidth(), croppedHeight);
 
-	// Create texture from generated image
-	auto texture = std::make_shared<LUNATexture>(image);
+	outFont.size = size;
+	outFont.outlineSize = outlineSize;
+	outFont.sdfSpread = sdfSpread;
+	outFont.image = image;
+	outFont.unknownChar = unknownChar;
+	outFont.chars = std::move(charRegions);
+	outFont.kerning = std::move(kerning);
 
-#if LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
-	// Cache generated texture to APP_DATA folder for reloading when lossing GL context
-	texture->Cache(image.GetData());
-#endif
+	return true;
+}
 
-	// Create font
-	auto font = std::make_shared<LUNAFont>(texture, size, outlineSize);
+std::shared_ptr<LUNAFont> LUNAFontGenerator::GenerateFont(int size)
+{
+	LUNABakedFont bakedFont;
+	if(!BakeFont(size, bakedFont)) return nullptr;
 
-	// Set texture regions for chars
-	for(auto region : charRegions) font->SetGlyph(region.c, region.ToGlyph(texture));
-	font->SetUnknownCharGlyph(unknownChar.ToGlyph(texture));
+	return bakedFont.MakeFont();
+}
 
-	return font;
+// Rasterize single char with given size. Used by dynamic fonts to rasterize chars on demand
+bool LUNAFontGenerator::RenderChar(char32_t c, int size, float outlineSize, LUNABakedFont::Char& outChar, std::vector<unsigned char>& outBitmap)
+{
+	if(!face) return false;
+
+	SetCharSize(size);
+
+	int outlineSizePixels = std::floor(outlineSize / LUNAEngine::SharedSizes()->GetTextureScale());
+	return RasterizeChar(c, outlineSizePixels, outChar, outBitmap);
 }
 
+// Get sizes of widest and highest char with given size
+void LUNAFontGenerator::GetMaxCharSize(int size, int& outWidth, int& outHeight)
+{
+	outWidth = 0;
+	outHeight = 0;
+	if(!face) return;
+
+	SetCharSize(size);
+
+	outWidth = UnitsToPixels(face->size->metrics.max_advance);
+	outHeight = UnitsToPixels(face->size->metrics.height);
+}
+
+// Get kerning offset in pixels between given chars with given size
+float LUNAFontGenerator::GetKerning(int size, char32_t left, char32_t right)
+{
+	if(!face) return 0;
+
+	SetCharSize(size);
+	return GetKerningPixels(left, right);
+}
@@ -39,6 +39,64 @@
 namespace luna2d{
 
 const int CHAR_PADDING = 1; // Size of padding between chars(in pixels)
+const int SDF_FONT_SIZE = 48; // Size of chars in distance field atlas
+const int SDF_SPREAD = 6; // Max distance to glyph edge stored in distance field(in pixels)
+
+//--------------------------------------------------------
+// Font rasterized by FreeType: atlas image and char metrics
+// Can be saved to cache and converted to font without FreeType
+//--------------------------------------------------------
+struct LUNABakedFont
+{
+	struct Char
+	{
+		Char() {}
+
+		Char(char32_t c, int regionX, int regionY, int regionWidth, int regionHeight,
+			float charWidth, float charHeight, float charOffsetX, float charOffsetY): c(c),
+			regionX(regionX), regionY(regionY), regionWidth(regionWidth), regionHeight(regionHeight),
+			charWidth(charWidth), charHeight(charHeight), charOffsetX(charOffsetX), charOffsetY(charOffsetY) {}
+
+		char32_t c = '\0';
+		int regionX = 0;
+		int regionY = 0;
+		int regionWidth = 0;
+		int regionHeight = 0;
+		float charWidth = 0;
+		float charHeight = 0;
+		float charOffsetX = 0;
+		float charOffsetY = 0;
+
+		// Make glyph for char region in given texture. Metrics are multiplied by "scale"
+		LUNAGlyph ToGlyph(const std::shared_ptr<LUNATexture>& texture, float scale = 1.0f) const;
+	};
+
+	struct KerningPair
+	{
+		KerningPair(char32_t left, char32_t right, float offset) : left(left), right(right), offset(offset) {}
+
+		char32_t left;
+		char32_t right;
+		float offset;
+	};
+
+	int size = 0;
+	float outlineSize = 0;
+	int sdfSpread = 0; // Spread of distance field in pixels. 0 for bitmap fonts
+	std::shared_ptr<LUNAImage> image;
+	Char unknownChar;
+	std::vector<Char> chars;
+	std::vector<KerningPair> kerning; // Only pairs with non-zero offset
+
+	// Create texture from atlas image
+	std::shared_ptr<LUNATexture> MakeTexture() const;
+
+	// Create texture from atlas image and make font from it
+	std::shared_ptr<LUNAFont> MakeFont() const;
+
+	// Make font with given size from distance field atlas. Fonts of all sizes can share one texture
+	std::shared_ptr<LUNAFont> MakeSdfFont(const std::shared_ptr<LUNATexture>& texture, int size, float outlineSize) const;
+};
 
 //----------------------------------------------
 // Util for generate bitmap fonts using FreeType
@@ -52,6 +110,7 @@ private:
 	FT_Library library = nullptr;
 	FT_Face face = nullptr;
 	std::vector<unsigned char> fontBuffer;
+	int charSize = 0; // Size of chars currently set to FreeType face
 
 public:
 	bool enableLatin = true;
@@ -61,16 +120,31 @@ public:
 	bool enableNumbers = true;
 	std::u32string customSymbols;
 	float outlineSize = 0;
+	int sdfSpread = 0; // When greater than 0, chars are baked as distance fields with given spread
 
 private:
 	// Conversions between pixels and internal FreeType units
 	int UnitsToPixels(int units);
 	int PixelsToUnits(int pixels);
 
+	void SetCharSize(int size);
+
+	// Rasterize one char with current char size. Bitmap has sizes of char region and ALPHA color type
+	bool RasterizeChar(char32_t c, int outlineSizePixels, LUNABakedFont::Char& outChar, std::vector<unsigned char>& outBitmap);
+
+	// Get kerning offset between given chars with current char size
+	float GetKerningPixels(char32_t left, char32_t right);
+
 public:
 	void ResetCharSets();
 	bool Load(const std::string& filename, LUNAFileLocation location = LUNAFileLocation::ASSETS); // Load
+	bool BakeFont(int size, LUNABakedFont& outFont); // Rasterize chars with given size into atlas image
 	std::shared_ptr<LUNAFont> GenerateFont(int size); // Create bitmap font with given size
+
+	// Rasterize single char with given size. Used by dynamic fonts to rasterize chars on demand
+	bool RenderChar(char32_t c, int size, float outlineSize, LUNABakedFont::Char& outChar, std::vector<unsigned char>& outBitmap);
+	void GetMaxCharSize(int size, int& outWidth, int& outHeight); // Get sizes of widest and highest char with given size
+	float GetKerning(int size, char32_t left, char32_t right); // Get kerning offset in pixels between given chars with given size
 };
 
 }
@@ -121,6 +121,12 @@ void LUNAFrameBuffer::SetLinearFilter()
 	texture->SetLinearFilter();
 }
 
+void LUNAFrameBuffer::Clear()
+{
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
 void LUNAFrameBuffer::Bind()
 {
 	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &this->prevId);
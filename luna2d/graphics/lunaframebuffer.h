@@ -51,6 +51,7 @@ public:
 	std::shared_ptr<LUNAImage> ReadPixels();
 	void SetNearestFilter();
 	void SetLinearFilter();
+	void Clear(); // Clear framebuffer to transparent color. Framebuffer should be bound
 	void Bind();
 	void Unbind();
 
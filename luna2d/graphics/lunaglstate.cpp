@@ -0,0 +1,265 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunaglstate.h"
+
+using namespace luna2d;
+
+bool LUNAGlState::valid = false;
+GLuint LUNAGlState::program = 0;
+GLenum LUNAGlState::activeUnit = GL_TEXTURE0;
+GLuint LUNAGlState::textures[GL_STATE_TEXTURE_UNITS] = {};
+GLuint LUNAGlState::arrayBuffer = 0;
+GLuint LUNAGlState::elementBuffer = 0;
+unsigned int LUNAGlState::enabledAttribs = 0;
+bool LUNAGlState::blending = false;
+GLenum LUNAGlState::blendSrc = GL_ONE;
+GLenum LUNAGlState::blendDst = GL_ZERO;
+GLenum LUNAGlState::blendSrcAlpha = GL_ONE;
+GLenum LUNAGlState::blendDstAlpha = GL_ZERO;
+int LUNAGlState::skippedCalls = 0;
+
+// Set all cached state explicitly to make cache match GL
+void LUNAGlState::Validate()
+{
+	if(valid) return;
+	valid = true;
+
+	glUseProgram(program = 0);
+
+	for(int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, textures[i] = 0);
+	}
+	glActiveTexture(activeUnit = GL_TEXTURE0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer = 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer = 0);
+
+	for(int i = 0; i < GL_STATE_VERTEX_ATTRIBS; i++) glDisableVertexAttribArray(i);
+	enabledAttribs = 0;
+
+	glDisable(GL_BLEND);
+	glBlendFunc(blendSrc = blendSrcAlpha = GL_ONE, blendDst = blendDstAlpha = GL_ZERO);
+	blending = false;
+}
+
+// Forget cached state. Should be called when GL state could be changed bypassing cache,
+// e.g. by platform code between frames or after GL context was lost
+void LUNAGlState::Invalidate()
+{
+	valid = false;
+}
+
+// Get count of GL calls skipped because state already was set
+int LUNAGlState::GetSkippedCalls()
+{
+	return skippedCalls;
+}
+
+void LUNAGlState::ResetSkippedCalls()
+{
+	skippedCalls = 0;
+}
+
+void LUNAGlState::UseProgram(GLuint program)
+{
+	Validate();
+
+	if(LUNAGlState::program == program)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	LUNAGlState::program = program;
+	glUseProgram(program);
+}
+
+void LUNAGlState::ActiveTexture(GLenum unit)
+{
+	Validate();
+
+	if(activeUnit == unit)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	activeUnit = unit;
+	glActiveTexture(unit);
+}
+
+// Bind texture to current active unit
+void LUNAGlState::BindTexture(GLuint texture)
+{
+	Validate();
+
+	int unit = activeUnit - GL_TEXTURE0;
+	if(unit < 0 || unit >= GL_STATE_TEXTURE_UNITS)
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+
+	if(textures[unit] == texture)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	textures[unit] = texture;
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void LUNAGlState::BindBuffer(GLenum target, GLuint buffer)
+{
+	Validate();
+
+	GLuint& bound = target == GL_ELEMENT_ARRAY_BUFFER ? elementBuffer : arrayBuffer;
+	if(bound == buffer)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	bound = buffer;
+	glBindBuffer(target, buffer);
+}
+
+void LUNAGlState::EnableVertexAttribArray(GLint index)
+{
+	Validate();
+
+	if(index < 0) return;
+	if(index >= GL_STATE_VERTEX_ATTRIBS)
+	{
+		glEnableVertexAttribArray(index);
+		return;
+	}
+
+	unsigned int bit = 1u << index;
+	if(enabledAttribs & bit)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	enabledAttribs |= bit;
+	glEnableVertexAttribArray(index);
+}
+
+void LUNAGlState::DisableVertexAttribArray(GLint index)
+{
+	Validate();
+
+	if(index < 0) return;
+	if(index >= GL_STATE_VERTEX_ATTRIBS)
+	{
+		glDisableVertexAttribArray(index);
+		return;
+	}
+
+	unsigned int bit = 1u << index;
+	if(!(enabledAttribs & bit))
+	{
+		skippedCalls++;
+		return;
+	}
+
+	enabledAttribs &= ~bit;
+	glDisableVertexAttribArray(index);
+}
+
+void LUNAGlState::EnableBlending(GLenum src, GLenum dst)
+{
+	Validate();
+
+	if(!blending)
+	{
+		blending = true;
+		glEnable(GL_BLEND);
+	}
+	else skippedCalls++;
+
+	if(blendSrc != src || blendDst != dst || blendSrcAlpha != src || blendDstAlpha != dst)
+	{
+		blendSrc = blendSrcAlpha = src;
+		blendDst = blendDstAlpha = dst;
+		glBlendFunc(src, dst);
+	}
+	else skippedCalls++;
+}
+
+// Separate function for alpha channel
+void LUNAGlState::EnableBlending(GLenum src, GLenum dst, GLenum srcAlpha, GLenum dstAlpha)
+{
+	Validate();
+
+	if(!blending)
+	{
+		blending = true;
+		glEnable(GL_BLEND);
+	}
+	else skippedCalls++;
+
+	if(blendSrc != src || blendDst != dst || blendSrcAlpha != srcAlpha || blendDstAlpha != dstAlpha)
+	{
+		blendSrc = src;
+		blendDst = dst;
+		blendSrcAlpha = srcAlpha;
+		blendDstAlpha = dstAlpha;
+		glBlendFuncSeparate(src, dst, srcAlpha, dstAlpha);
+	}
+	else skippedCalls++;
+}
+
+void LUNAGlState::DisableBlending()
+{
+	Validate();
+
+	if(!blending)
+	{
+		skippedCalls++;
+		return;
+	}
+
+	blending = false;
+	glDisable(GL_BLEND);
+}
+
+// Deleted objects are unbound by GL, so cache should forget them too
+void LUNAGlState::OnDeleteTexture(GLuint texture)
+{
+	for(int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+	{
+		if(textures[i] == texture) textures[i] = 0;
+	}
+}
+
+void LUNAGlState::OnDeleteBuffer(GLuint buffer)
+{
+	if(arrayBuffer == buffer) arrayBuffer = 0;
+	if(elementBuffer == buffer) elementBuffer = 0;
+}
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunagl.h"
+
+namespace luna2d{
+
+const int GL_STATE_TEXTURE_UNITS = 8; // Minimal count of texture units guaranteed by OpenGL ES 2.0
+const int GL_STATE_VERTEX_ATTRIBS = 8; // Minimal count of vertex attributes guaranteed by OpenGL ES 2.0
+
+//-------------------------------------------------------------
+// Cache of GL state. Skips GL calls which don't change state
+// All binding of programs, textures and buffers, enabling of
+// vertex attributes and blending should be done through it
+//-------------------------------------------------------------
+class LUNAGlState
+{
+private:
+	LUNAGlState() = delete;
+
+private:
+	static bool valid; // Cached values are unknown until first call after "Invalidate"
+	static GLuint program;
+	static GLenum activeUnit;
+	static GLuint textures[GL_STATE_TEXTURE_UNITS];
+	static GLuint arrayBuffer;
+	static GLuint elementBuffer;
+	static unsigned int enabledAttribs; // Bit mask of enabled vertex attribute arrays
+	static bool blending;
+	static GLenum blendSrc, blendDst;
+	static GLenum blendSrcAlpha, blendDstAlpha;
+	static int skippedCalls;
+
+private:
+	static void Validate();
+
+public:
+	// Forget cached state. Should be called when GL state could be changed bypassing cache,
+	// e.g. by platform code between frames or after GL context was lost
+	static void Invalidate();
+
+	// Get count of GL calls skipped because state already was set
+	static int GetSkippedCalls();
+	static void ResetSkippedCalls();
+
+	static void UseProgram(GLuint program);
+	static void ActiveTexture(GLenum unit);
+	static void BindTexture(GLuint texture); // Bind texture to current active unit
+	static void BindBuffer(GLenum target, GLuint buffer);
+	static void EnableVertexAttribArray(GLint index);
+	static void DisableVertexAttribArray(GLint index);
+	static void EnableBlending(GLenum src, GLenum dst);
+	static void EnableBlending(GLenum src, GLenum dst, GLenum srcAlpha, GLenum dstAlpha); // Separate function for alpha channel
+	static void DisableBlending();
+
+	// Deleted objects are unbound by GL, so cache should forget them too
+	static void OnDeleteTexture(GLuint texture);
+	static void OnDeleteBuffer(GLuint buffer);
+};
+
+}
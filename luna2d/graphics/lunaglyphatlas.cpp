@@ -0,0 +1,211 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunaglyphatlas.h"
+#include "lunagraphics.h"
+#include "lunasizes.h"
+
+using namespace luna2d;
+
+LUNAGlyphAtlas::LUNAGlyphAtlas(const std::shared_ptr<LUNAFontGenerator>& generator, int size, float outlineSize, int pageSize) :
+	generator(generator),
+	size(size),
+	outlineSize(outlineSize),
+	pageSize(pageSize)
+{
+	generator->GetMaxCharSize(size, maxCharWidth, maxCharHeight);
+
+	texture = std::make_shared<LUNATexture>(MakeEmptyPage());
+	unknownChar = LUNABakedFont::Char('\0', 0, 0, maxCharWidth, maxCharHeight, maxCharWidth, maxCharHeight,
+		0.0f, 0.0f).ToGlyph(texture);
+	contextVersion = LUNAEngine::SharedGraphics()->GetRenderer()->GetContextVersion();
+	ResetShelves();
+}
+
+// Make image of page containing only placeholder for unknown char
+LUNAImage LUNAGlyphAtlas::MakeEmptyPage()
+{
+	LUNAImage image(pageSize, pageSize, LUNAColorType::ALPHA);
+
+	// Fill image with white transparent color to avoid black artefacts around chars
+	image.Fill(LUNAColor::Rgb(255, 255, 255, 0));
+
+	// Draw placeholder for unknown char
+	image.FillRectangle(0, 0, maxCharWidth - 1, maxCharHeight, LUNAColor::WHITE);
+
+	return image;
+}
+
+void LUNAGlyphAtlas::ResetShelves()
+{
+	shelves.clear();
+	charShelves.clear();
+
+	// Reserve whole first shelf for unknown char
+	shelves.push_back(Shelf(0, maxCharHeight + CHAR_PADDING));
+	shelves[0].penX = pageSize;
+	nextShelfY = maxCharHeight + CHAR_PADDING;
+}
+
+unsigned int LUNAGlyphAtlas::GetCurrentFrame()
+{
+	return LUNAEngine::SharedGraphics()->GetRenderer()->GetFrameIndex();
+}
+
+int LUNAGlyphAtlas::FindShelf(int width, int height, std::vector<char32_t>& outEvicted)
+{
+	// Find lowest shelf having space for char
+	int best = -1;
+	for(size_t i = 1; i < shelves.size(); i++)
+	{
+		const Shelf& shelf = shelves[i];
+		if(shelf.height < height || shelf.penX + width > pageSize) continue;
+		if(best == -1 || shelf.height < shelves[best].height) best = i;
+	}
+
+	// Don't waste much higher shelves while page has free space
+	if(best != -1 && shelves[best].height - height <= height / 2) return best;
+
+	// Open new shelf
+	if(nextShelfY + height <= pageSize)
+	{
+		shelves.push_back(Shelf(nextShelfY, height));
+		nextShelfY += height;
+		return shelves.size() - 1;
+	}
+
+	if(best != -1) return best;
+
+	// Page is full. Evict least recently used shelf
+	// Shelves used on current frame cannot be evicted because its glyphs can be already sent to renderer
+	unsigned int currentFrame = GetCurrentFrame();
+	int lru = -1;
+	for(size_t i = 1; i < shelves.size(); i++)
+	{
+		const Shelf& shelf = shelves[i];
+		if(shelf.height < height || shelf.lastUsedFrame == currentFrame) continue;
+		if(lru == -1 || shelf.lastUsedFrame < shelves[lru].lastUsedFrame) lru = i;
+	}
+
+	if(lru != -1) EvictShelf(shelves[lru], outEvicted);
+	return lru;
+}
+
+void LUNAGlyphAtlas::EvictShelf(Shelf& shelf, std::vector<char32_t>& outEvicted)
+{
+	for(char32_t c : shelf.chars)
+	{
+		charShelves.erase(c);
+		outEvicted.push_back(c);
+	}
+
+	shelf.chars.clear();
+	shelf.penX = 0;
+
+	// Clear pixels of evicted chars
+	std::vector<unsigned char> emptyPixels(pageSize * shelf.height, 0);
+	texture->UpdateRegion(0, shelf.y, pageSize, shelf.height, &emptyPixels[0]);
+
+	evictedShelves++;
+}
+
+std::shared_ptr<LUNATexture> LUNAGlyphAtlas::GetTexture()
+{
+	return texture;
+}
+
+const LUNAGlyph& LUNAGlyphAtlas::GetUnknownCharGlyph()
+{
+	return unknownChar;
+}
+
+// Get count of shelves evicted from page
+int LUNAGlyphAtlas::GetEvictedShelves()
+{
+	return evictedShelves;
+}
+
+// Recreate page when it was lost with GL context
+// Returns true when all glyphs were removed from page and should be rasterized again
+bool LUNAGlyphAtlas::CheckContext()
+{
+	int rendererContext = LUNAEngine::SharedGraphics()->GetRenderer()->GetContextVersion();
+	if(contextVersion == rendererContext) return false;
+
+	contextVersion = rendererContext;
+	texture->Recreate(MakeEmptyPage());
+	ResetShelves();
+	return true;
+}
+
+// Rasterize char and add it to page. Chars of evicted shelves are added to "outEvicted"
+// Returns false when page has no space for char on current frame
+bool LUNAGlyphAtlas::AddGlyph(char32_t c, LUNAGlyph& outGlyph, std::vector<char32_t>& outEvicted)
+{
+	LUNABakedFont::Char bakedChar;
+	std::vector<unsigned char> bitmap;
+
+	// Chars missing in font use placeholder
+	if(!generator->RenderChar(c, size, outlineSize, bakedChar, bitmap))
+	{
+		outGlyph = unknownChar;
+		return true;
+	}
+
+	int width = bakedChar.regionWidth + CHAR_PADDING;
+	int height = bakedChar.regionHeight + CHAR_PADDING;
+	int index = width <= pageSize && height <= pageSize ? FindShelf(width, height, outEvicted) : -1;
+	if(index == -1)
+	{
+		if(!warnedFull) LUNA_LOGE("Not enough space in glyph page of dynamic font. Try increase \"pageSize\" of font");
+		warnedFull = true;
+		return false;
+	}
+
+	Shelf& shelf = shelves[index];
+	bakedChar.regionX = shelf.penX;
+	bakedChar.regionY = shelf.y;
+
+	if(!bitmap.empty()) texture->UpdateRegion(shelf.penX, shelf.y, bakedChar.regionWidth, bakedChar.regionHeight, &bitmap[0]);
+
+	shelf.penX += width;
+	shelf.lastUsedFrame = GetCurrentFrame();
+	shelf.chars.push_back(c);
+	charShelves[c] = index;
+
+	outGlyph = bakedChar.ToGlyph(texture);
+	return true;
+}
+
+// Mark glyph as used on current frame
+void LUNAGlyphAtlas::TouchGlyph(char32_t c)
+{
+	auto it = charShelves.find(c);
+	if(it != charShelves.end()) shelves[it->second].lastUsedFrame = GetCurrentFrame();
+}
+
+// Get kerning offset between given chars
+float LUNAGlyphAtlas::GetKerning(char32_t left, char32_t right)
+{
+	return generator->GetKerning(size, left, right) * LUNAEngine::SharedSizes()->GetTextureScale();
+}
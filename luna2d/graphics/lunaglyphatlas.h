@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunafontgenerator.h"
+
+namespace luna2d{
+
+//---------------------------------------------------------------------
+// Texture page for glyphs of dynamic font. Glyphs are rasterized on
+// first use and packed to shelves. When page is full, least recently
+// used shelf is evicted and reused for new glyphs
+//---------------------------------------------------------------------
+class LUNAGlyphAtlas
+{
+public:
+	LUNAGlyphAtlas(const std::shared_ptr<LUNAFontGenerator>& generator, int size, float outlineSize, int pageSize);
+
+private:
+	struct Shelf
+	{
+		Shelf(int y, int height) : y(y), height(height) {}
+
+		int y;
+		int height;
+		int penX = 0;
+		unsigned int lastUsedFrame = 0;
+		std::vector<char32_t> chars;
+	};
+
+	std::shared_ptr<LUNAFontGenerator> generator;
+	int size;
+	float outlineSize;
+	int pageSize;
+	std::shared_ptr<LUNATexture> texture;
+	LUNAGlyph unknownChar;
+	std::vector<Shelf> shelves; // First shelf is reserved for unknown char and never evicted
+	std::unordered_map<char32_t, size_t> charShelves; // Index of shelf for each char in page
+	int maxCharWidth = 0, maxCharHeight = 0;
+	int contextVersion = 0; // Version of GL context when page was created
+	int nextShelfY = 0;
+	int evictedShelves = 0;
+	bool warnedFull = false;
+
+private:
+	LUNAImage MakeEmptyPage(); // Make image of page containing only placeholder for unknown char
+	void ResetShelves();
+	unsigned int GetCurrentFrame();
+	int FindShelf(int width, int height, std::vector<char32_t>& outEvicted);
+	void EvictShelf(Shelf& shelf, std::vector<char32_t>& outEvicted);
+
+public:
+	std::shared_ptr<LUNATexture> GetTexture();
+	const LUNAGlyph& GetUnknownCharGlyph();
+	int GetEvictedShelves(); // Get count of shelves evicted from page
+
+	// Recreate page when it was lost with GL context
+	// Returns true when all glyphs were removed from page and should be rasterized again
+	bool CheckContext();
+
+	// Rasterize char and add it to page. Chars of evicted shelves are added to "outEvicted"
+	// Returns false when page has no space for char on current frame
+	bool AddGlyph(char32_t c, LUNAGlyph& outGlyph, std::vector<char32_t>& outEvicted);
+
+	void TouchGlyph(char32_t c); // Mark glyph as used on current frame
+	float GetKerning(char32_t left, char32_t right); // Get kerning offset between given chars
+};
+
+}
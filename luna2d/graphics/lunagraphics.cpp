@@ -28,13 +28,17 @@
 #include "lunarenderer.h"
 #include "lunaanimation.h"
 #include "lunamesh.h"
+#include "lunaspritebatch.h"
+#include "lunatilemap.h"
 #include "lunatext.h"
 #include "lunaparticlesystem.h"
 #include "lunacurve.h"
 #include "lunaradialmesh.h"
 #include "lunaframebuffer.h"
+#include "lunacachedlayer.h"
 #include "lunapngformat.h"
 #include "lunajpegformat.h"
+#include "lunaglhelpers.h"
 
 using namespace luna2d;
 
@@ -59,6 +63,11 @@ LUNAGraphics::LUNAGraphics() :
 	tblGraphics.SetField("getDeltaTime", LuaFunction(lua, this, &LUNAGraphics::GetDeltaTime));
 	tblGraphics.SetField("getRenderCalls", LuaFunction(lua, this, &LUNAGraphics::GetRenderCalls));
 	tblGraphics.SetField("getRenderedVertexes", LuaFunction(lua, this, &LUNAGraphics::GetRenderedVertexes));
+	tblGraphics.SetField("getCulledObjects", LuaFunction(lua, this, &LUNAGraphics::GetCulledObjects));
+	tblGraphics.SetField("getRenderStats", LuaFunction(lua, this, &LUNAGraphics::GetRenderStats));
+	tblGraphics.SetField("getSkippedGlCalls", LuaFunction(lua, &LUNAGlState::GetSkippedCalls));
+	tblGraphics.SetField("setGlErrorCheckInterval", LuaFunction(lua, &glSetErrorCheckInterval));
+	tblGraphics.SetField("getSavedRenderCalls", LuaFunction(lua, &renderer, &LUNARenderer::GetSavedRenderCalls));
 	tblGraphics.SetField("getCamera", LuaFunction(lua, this, &LUNAGraphics::GetCamera));
 	tblGraphics.SetField("setBackgroundColor", LuaFunction(lua, this, &LUNAGraphics::SetBackgroundColor));
 	tblGraphics.SetField("getDefaultShader", LuaFunction(lua, &renderer, &LUNARenderer::GetDefaultShader));
@@ -66,6 +75,14 @@ LUNAGraphics::LUNAGraphics() :
 	tblGraphics.SetField("disableScissor", LuaFunction(lua, &renderer, &LUNARenderer::DisableScissor));
 	tblGraphics.SetField("setFrameBuffer", LuaFunction(lua, &renderer, &LUNARenderer::SetFrameBuffer));
 	tblGraphics.SetField("enableDebugRender", LuaFunction(lua, &renderer, &LUNARenderer::EnableDebugRender));
+	tblGraphics.SetField("enableVertexBuffers", LuaFunction(lua, &renderer, &LUNARenderer::EnableVertexBuffers));
+	tblGraphics.SetField("enableRenderSorting", LuaFunction(lua, &renderer, &LUNARenderer::EnableRenderSorting));
+	tblGraphics.SetField("setRenderLayer", LuaFunction(lua, &renderer, &LUNARenderer::SetRenderLayer));
+	tblGraphics.SetField("isPremultipliedAlpha", LuaFunction(lua, &renderer, &LUNARenderer::IsPremultipliedAlpha));
+	tblGraphics.SetField("enableParallelBuild", LuaFunction(lua, &renderer, &LUNARenderer::EnableParallelBuild));
+	tblGraphics.SetField("enableOpaquePass", LuaFunction(lua, &renderer, &LUNARenderer::EnableOpaquePass));
+	tblGraphics.SetField("enableCulling", LuaFunction(lua, &renderer, &LUNARenderer::EnableCulling));
+	tblGraphics.SetField("enableMultiTexture", LuaFunction(lua, &renderer, &LUNARenderer::EnableMultiTexture));
 	tblGraphics.SetField("renderLine", LuaFunction(lua, &renderer, &LUNARenderer::RenderLine));
 
 	// Bind camera
@@ -78,6 +95,7 @@ LUNAGraphics::LUNAGraphics() :
 	clsCamera.SetMethod("setPos", &LUNACamera::SetPos);
 	clsCamera.SetMethod("getZoom", &LUNACamera::GetZoom);
 	clsCamera.SetMethod("setZoom", &LUNACamera::SetZoom);
+	clsCamera.SetMethod("getViewRect", &LUNACamera::GetViewRect);
 
 	// Bind sprite
 	LuaClass<LUNASprite> clsSprite(lua);
@@ -137,12 +155,56 @@ LUNAGraphics::LUNAGraphics() :
 	clsAnimation.SetMethod("update", &LUNAAnimation::Update);
 	tblGraphics.SetField("Animation", clsAnimation);
 
+	// Bind sprite batch
+	LuaClass<LUNASpriteBatch> clsSpriteBatch(lua);
+	clsSpriteBatch.SetConstructor<const LuaAny&>();
+	clsSpriteBatch.SetMethod("getCount", &LUNASpriteBatch::GetCount);
+	clsSpriteBatch.SetMethod("add", &LUNASpriteBatch::Add);
+	clsSpriteBatch.SetMethod("addMany", &LUNASpriteBatch::AddMany);
+	clsSpriteBatch.SetMethod("remove", &LUNASpriteBatch::Remove);
+	clsSpriteBatch.SetMethod("clear", &LUNASpriteBatch::Clear);
+	clsSpriteBatch.SetMethod("getPos", &LUNASpriteBatch::GetPos);
+	clsSpriteBatch.SetMethod("setPos", &LUNASpriteBatch::SetPos);
+	clsSpriteBatch.SetMethod("setPositions", &LUNASpriteBatch::SetPositions);
+	clsSpriteBatch.SetMethod("setSize", &LUNASpriteBatch::SetSize);
+	clsSpriteBatch.SetMethod("setOrigin", &LUNASpriteBatch::SetOrigin);
+	clsSpriteBatch.SetMethod("setScale", &LUNASpriteBatch::SetScale);
+	clsSpriteBatch.SetMethod("getAngle", &LUNASpriteBatch::GetAngle);
+	clsSpriteBatch.SetMethod("setAngle", &LUNASpriteBatch::SetAngle);
+	clsSpriteBatch.SetMethod("setAngles", &LUNASpriteBatch::SetAngles);
+	clsSpriteBatch.SetMethod("setColor", &LUNASpriteBatch::SetColor);
+	clsSpriteBatch.SetMethod("setAlpha", &LUNASpriteBatch::SetAlpha);
+	clsSpriteBatch.SetMethod("setRegion", &LUNASpriteBatch::SetRegion);
+	clsSpriteBatch.SetMethod("setShader", &LUNASpriteBatch::SetShader);
+	clsSpriteBatch.SetMethod("getBlendingMode", &LUNASpriteBatch::GetBlendingMode);
+	clsSpriteBatch.SetMethod("setBlendingMode", &LUNASpriteBatch::SetBlendingMode);
+	clsSpriteBatch.SetMethod("render", &LUNASpriteBatch::Render);
+	tblGraphics.SetField("SpriteBatch", clsSpriteBatch);
+
+	// Bind tile map
+	LuaClass<LUNATileMap> clsTileMap(lua);
+	clsTileMap.SetConstructor<const std::vector<std::weak_ptr<LUNATextureRegion>>&, int, int, float, float>();
+	clsTileMap.SetMethod("getColumns", &LUNATileMap::GetColumns);
+	clsTileMap.SetMethod("getRows", &LUNATileMap::GetRows);
+	clsTileMap.SetMethod("getPos", &LUNATileMap::GetPos);
+	clsTileMap.SetMethod("setPos", &LUNATileMap::SetPos);
+	clsTileMap.SetMethod("getTile", &LUNATileMap::GetTile);
+	clsTileMap.SetMethod("setTile", &LUNATileMap::SetTile);
+	clsTileMap.SetMethod("setTiles", &LUNATileMap::SetTiles);
+	clsTileMap.SetMethod("setShader", &LUNATileMap::SetShader);
+	clsTileMap.SetMethod("render", &LUNATileMap::Render);
+	tblGraphics.SetField("TileMap", clsTileMap);
+
 	// Bind mesh
 	LuaClass<LUNAMesh> clsMesh(lua);
 	clsMesh.SetConstructor<const std::weak_ptr<LUNATexture>&>();
 	clsMesh.SetMethod("clear", &LUNAMesh::Clear);
 	clsMesh.SetMethod("setTexture", &LUNAMesh::SetTexture);
 	clsMesh.SetMethod("addVertex", &LUNAMesh::AddVertex);
+	clsMesh.SetMethod("addIndexedVertex", &LUNAMesh::AddIndexedVertex);
+	clsMesh.SetMethod("addIndex", &LUNAMesh::AddIndex);
+	clsMesh.SetMethod("isStatic", &LUNAMesh::IsStatic);
+	clsMesh.SetMethod("setStatic", &LUNAMesh::SetStatic);
 	clsMesh.SetMethod("render", &LUNAMesh::Render);
 	tblGraphics.SetField("Mesh", clsMesh);
 
@@ -164,12 +226,18 @@ LUNAGraphics::LUNAGraphics() :
 	clsText.SetMethod("setScale", &LUNAText::SetScale);
 	clsText.SetMethod("getWidth", &LUNAText::GetWidth);
 	clsText.SetMethod("getHeight", &LUNAText::GetHeight);
+	clsText.SetMethod("getLinesHeight", &LUNAText::GetLinesHeight);
 	clsText.SetMethod("setColor", &LUNAText::SetColor);
 	clsText.SetMethod("getColor", &LUNAText::GetColor);
 	clsText.SetMethod("setAlpha", &LUNAText::SetAlpha);
 	clsText.SetMethod("getAlpha", &LUNAText::GetAlpha);
 	clsText.SetMethod("getText", &LUNAText::GetText);
 	clsText.SetMethod("setText", &LUNAText::SetText);
+	clsText.SetMethod("getMaxWidth", &LUNAText::GetMaxWidth);
+	clsText.SetMethod("setMaxWidth", &LUNAText::SetMaxWidth);
+	clsText.SetMethod("getAlign", &LUNAText::GetAlign);
+	clsText.SetMethod("setAlign", &LUNAText::SetAlign);
+	clsText.SetMethod("getLinesCount", &LUNAText::GetLinesCount);
 	clsText.SetMethod("render", &LUNAText::Render);
 	tblGraphics.SetField("Text", clsText);
 
@@ -293,6 +361,8 @@ LUNAGraphics::LUNAGraphics() :
 	clsFont.SetMethod("getOutlineSize", &LUNAFont::GetOutlineSize);
 	clsFont.SetMethod("getStringWidth", &LUNAFont::GetStringWidth);
 	clsFont.SetMethod("getStringHeight", &LUNAFont::GetStringHeight);
+	clsFont.SetMethod("isDynamic", &LUNAFont::IsDynamic);
+	clsFont.SetMethod("isDistanceField", &LUNAFont::IsDistanceField);
 
 	// Bind pixmap
 	LuaClass<LUNAImage> clsImage(lua);
@@ -306,6 +376,7 @@ LUNAGraphics::LUNAGraphics() :
 	clsImage.SetMethod("getHeight", &LUNAImage::GetHeight);
 	clsImage.SetMethod("flipVertically", &LUNAImage::FlipVertically);
 	clsImage.SetMethod("flipHorizontally", &LUNAImage::FlipHorizontally);
+	clsImage.SetMethod("premultiplyAlpha", &LUNAImage::PremultiplyAlpha);
 
 	std::function<void(const std::shared_ptr<LUNAImage>&, const LUNAColor&, LuaAny)> fnFill =
 		[](const std::shared_ptr<LUNAImage>& thisPixmap, const LUNAColor& color, LuaAny blendingMode)
@@ -375,6 +446,18 @@ LUNAGraphics::LUNAGraphics() :
 	clsFrameBuffer.SetField("fullscreen", LuaFunction(lua, fnFrameBufferConstruct));
 	tblGraphics.SetField("FrameBuffer", clsFrameBuffer);
 
+	// Bind cached layer
+	LuaClass<LUNACachedLayer> clsCachedLayer(lua);
+	clsCachedLayer.SetConstructor<const LuaFunction&>();
+	clsCachedLayer.SetMethod("invalidate", &LUNACachedLayer::Invalidate);
+	clsCachedLayer.SetMethod("isDirty", &LUNACachedLayer::IsDirty);
+	clsCachedLayer.SetMethod("watch", &LUNACachedLayer::Watch);
+	clsCachedLayer.SetMethod("getHits", &LUNACachedLayer::GetHits);
+	clsCachedLayer.SetMethod("getMisses", &LUNACachedLayer::GetMisses);
+	clsCachedLayer.SetMethod("resetCounters", &LUNACachedLayer::ResetCounters);
+	clsCachedLayer.SetMethod("render", &LUNACachedLayer::Render);
+	tblGraphics.SetField("CachedLayer", clsCachedLayer);
+
 	// Bind color
 	LuaTable tblColor(lua);
 
@@ -424,6 +507,11 @@ LUNARenderer* LUNAGraphics::GetRenderer()
 	return &renderer;
 }
 
+LUNAScreenshots* LUNAGraphics::GetScreenshots()
+{
+	return &screenshots;
+}
+
 const std::shared_ptr<LUNACamera>& LUNAGraphics::GetCamera()
 {
 	return camera;
@@ -449,6 +537,42 @@ int LUNAGraphics::GetRenderedVertexes()
 	return renderer.GetRenderedVertexes();
 }
 
+int LUNAGraphics::GetCulledObjects()
+{
+	return renderer.GetCulledObjects();
+}
+
+// Get reasons and sizes of batch flushes on last rendered frame
+LuaTable LUNAGraphics::GetRenderStats()
+{
+	LuaScript* lua = LUNAEngine::SharedLua();
+	const LUNARenderStats& stats = renderer.GetRenderStats();
+
+	LuaTable tblFlushes(lua);
+	for(int i = 0; i < FLUSH_REASONS_COUNT; i++)
+	{
+		LUNAFlushReason reason = static_cast<LUNAFlushReason>(i);
+		tblFlushes.SetField(FLUSH_REASON.FromEnum(reason), stats.GetFlushes(reason));
+	}
+
+	LuaTable tblReasons(lua);
+	LuaTable tblSizes(lua);
+	const auto& reasons = stats.GetBatchReasons();
+	const auto& sizes = stats.GetBatchSizes();
+	for(size_t i = 0; i < reasons.size(); i++)
+	{
+		tblReasons.SetArrayField(i + 1, FLUSH_REASON.FromEnum(reasons[i]));
+		tblSizes.SetArrayField(i + 1, sizes[i]);
+	}
+
+	LuaTable tblRet(lua);
+	tblRet.SetField("flushes", tblFlushes);
+	tblRet.SetField("batchReasons", tblReasons);
+	tblRet.SetField("batchSizes", tblSizes);
+
+	return tblRet;
+}
+
 void LUNAGraphics::ResetLastTime()
 {
 	lastTime = LUNAEngine::SharedPlatformUtils()->GetSystemTime();
@@ -506,6 +630,9 @@ void LUNAGraphics::OnUpdate()
 		framesCount = 0;
 	}
 
+	// Screenshot callbacks can be called only from main thread
+	screenshots.Update();
+
 	LUNAEngine::SharedScenes()->OnUpdate(deltaTime);
 
 	// Render
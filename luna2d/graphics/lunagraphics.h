@@ -24,6 +24,7 @@
 #pragma once
 
 #include "lunarenderer.h"
+#include "lunascreenshots.h"
 
 namespace luna2d{
 
@@ -39,6 +40,7 @@ public:
 private:
 	LUNARenderer renderer;
 	std::shared_ptr<LUNACamera> camera;
+	LUNAScreenshots screenshots;
 
 	// For calculating delta time and FPS
 	double lastTime, fpsTime, deltaTime, movAvgDelta;
@@ -53,11 +55,14 @@ private:
 
 public:
 	LUNARenderer* GetRenderer();
+	LUNAScreenshots* GetScreenshots();
 	const std::shared_ptr<LUNACamera>& GetCamera();
 	int GetFps();
 	float GetDeltaTime();
 	int GetRenderCalls();
 	int GetRenderedVertexes();
+	int GetCulledObjects();
+	LuaTable GetRenderStats(); // Get reasons and sizes of batch flushes on last rendered frame
 	void ResetLastTime();
 	void SetBackgroundColor(float r, float g, float b);
 	void RunAfterRender(const std::function<void()>& action); // Run given action after render current frame
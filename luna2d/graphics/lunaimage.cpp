@@ -442,3 +442,17 @@ void LUNAImage::FlipHorizontally()
 		}
 	}
 }
+
+// Multiply color components by alpha. Only RGBA images have alpha to premultiply
+void LUNAImage::PremultiplyAlpha()
+{
+	if(colorType != LUNAColorType::RGBA) return;
+
+	for(size_t i = 0; i + 3 < data.size(); i += 4)
+	{
+		unsigned int alpha = data[i + 3];
+		data[i] = (unsigned char)((data[i] * alpha + 127) / 255);
+		data[i + 1] = (unsigned char)((data[i + 1] * alpha + 127) / 255);
+		data[i + 2] = (unsigned char)((data[i + 2] * alpha + 127) / 255);
+	}
+}
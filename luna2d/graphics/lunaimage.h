@@ -118,6 +118,9 @@ public:
 
 	// Flip image horizontally
 	void FlipHorizontally();
+
+	// Multiply color components by alpha. Only RGBA images have alpha to premultiply
+	void PremultiplyAlpha();
 };
 
 }
@@ -26,30 +26,119 @@
 
 using namespace luna2d;
 
-LUNAMaterial::LUNAMaterial() :
-	shader(LUNAEngine::SharedGraphics()->GetRenderer()->GetDefaultShader()),
-	blending(LUNABlendingMode::ALPHA)
+// Check for two weak pointers point to same object without locking them
+template<typename T>
+static inline bool IsSameOwner(const std::weak_ptr<T>& a, const std::weak_ptr<T>& b)
 {
+	return !a.owner_before(b) && !b.owner_before(a);
+}
+
+LUNAMaterial::LUNAMaterial()
+{
+	Intern(std::weak_ptr<LUNATexture>(), GetDefaultShader(), LUNABlendingMode::ALPHA);
 }
 
 LUNAMaterial::LUNAMaterial(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
-	LUNABlendingMode blending) :
-	texture(texture),
-	shader(shader),
-	blending(blending)
+	LUNABlendingMode blending)
 {
+	Intern(texture, shader, blending);
 }
 
-bool LUNAMaterial::operator==(const LUNAMaterial& material) const
+LUNAMaterialRegistry* LUNAMaterial::GetRegistry()
+{
+	return LUNAEngine::SharedGraphics()->GetRenderer()->GetMaterialRegistry();
+}
+
+std::weak_ptr<LUNAShader> LUNAMaterial::GetDefaultShader()
+{
+	return LUNAEngine::SharedGraphics()->GetRenderer()->GetDefaultShader();
+}
+
+void LUNAMaterial::Intern(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
+	LUNABlendingMode blending)
+{
+	handle = GetRegistry()->Intern(texture, shader, blending);
+}
+
+uint32_t LUNAMaterial::GetHandle() const
+{
+	return handle;
+}
+
+// Check for texture and shader aren't expired
+bool LUNAMaterial::IsValid() const
+{
+	auto entry = GetRegistry()->Get(handle);
+	return entry && !entry->texture.expired() && !entry->shader.expired();
+}
+
+std::weak_ptr<LUNATexture> LUNAMaterial::GetTexture() const
+{
+	auto entry = GetRegistry()->Get(handle);
+	return entry ? entry->texture : std::weak_ptr<LUNATexture>();
+}
+
+void LUNAMaterial::SetTexture(const std::weak_ptr<LUNATexture>& texture)
 {
-	if(blending != material.blending) return false;
-	if(texture.lock() != material.texture.lock()) return false;
-	if(shader.lock() != material.shader.lock()) return false;
+	auto entry = GetRegistry()->Get(handle);
+	if(!entry)
+	{
+		Intern(texture, GetDefaultShader(), LUNABlendingMode::ALPHA);
+		return;
+	}
 
-	return true;
+	// Skip interning when texture isn't changed
+	if(IsSameOwner(entry->texture, texture) && !texture.expired()) return;
+
+	Intern(texture, entry->shader, entry->blending);
+}
+
+std::weak_ptr<LUNAShader> LUNAMaterial::GetShader() const
+{
+	auto entry = GetRegistry()->Get(handle);
+	return entry ? entry->shader : std::weak_ptr<LUNAShader>();
+}
+
+void LUNAMaterial::SetShader(const std::weak_ptr<LUNAShader>& shader)
+{
+	auto entry = GetRegistry()->Get(handle);
+	if(!entry)
+	{
+		Intern(std::weak_ptr<LUNATexture>(), shader, LUNABlendingMode::ALPHA);
+		return;
+	}
+
+	if(IsSameOwner(entry->shader, shader) && !shader.expired()) return;
+
+	Intern(entry->texture, shader, entry->blending);
+}
+
+LUNABlendingMode LUNAMaterial::GetBlending() const
+{
+	auto entry = GetRegistry()->Get(handle);
+	return entry ? entry->blending : LUNABlendingMode::ALPHA;
+}
+
+void LUNAMaterial::SetBlending(LUNABlendingMode blending)
+{
+	auto entry = GetRegistry()->Get(handle);
+	if(!entry)
+	{
+		Intern(std::weak_ptr<LUNATexture>(), GetDefaultShader(), blending);
+		return;
+	}
+
+	if(entry->blending == blending) return;
+
+	Intern(entry->texture, entry->shader, blending);
+}
+
+bool LUNAMaterial::operator==(const LUNAMaterial& material) const
+{
+	return handle == material.handle;
 }
 
 bool LUNAMaterial::operator!=(const LUNAMaterial& material) const
 {
-	return !operator==(material);
+	return handle != material.handle;
 }
@@ -23,12 +23,16 @@
 
 #pragma once
 
-#include "lunatexture.h"
-#include "lunashader.h"
-#include "lunablendingmode.h"
+#include "lunamaterialregistry.h"
 
 namespace luna2d{
 
+//-------------------------------------------------------
+// Compact material handle. Texture, shader and blending
+// mode are interned in renderer's material registry.
+// If handle became stale (texture or shader was deleted
+// and entry was reused), setters start from defaults
+//-------------------------------------------------------
 class LUNAMaterial
 {
 public:
@@ -36,12 +40,30 @@ public:
 	LUNAMaterial(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
 		LUNABlendingMode blending);
 
-public:
-	std::weak_ptr<LUNATexture> texture;
-	std::weak_ptr<LUNAShader> shader;
-	LUNABlendingMode blending;
+private:
+	uint32_t handle = 0;
+
+private:
+	static LUNAMaterialRegistry* GetRegistry();
+	static std::weak_ptr<LUNAShader> GetDefaultShader();
+	void Intern(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
+		LUNABlendingMode blending);
 
 public:
+	uint32_t GetHandle() const;
+
+	// Check for texture and shader aren't expired
+	bool IsValid() const;
+
+	std::weak_ptr<LUNATexture> GetTexture() const;
+	void SetTexture(const std::weak_ptr<LUNATexture>& texture);
+
+	std::weak_ptr<LUNAShader> GetShader() const;
+	void SetShader(const std::weak_ptr<LUNAShader>& shader);
+
+	LUNABlendingMode GetBlending() const;
+	void SetBlending(LUNABlendingMode blending);
+
 	bool operator==(const LUNAMaterial& material) const;
 	bool operator!=(const LUNAMaterial& material) const;
 };
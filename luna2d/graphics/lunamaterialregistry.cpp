@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunamaterialregistry.h"
+
+using namespace luna2d;
+
+const uint32_t MATERIAL_HANDLE_INDEX_MASK = (1u << MATERIAL_HANDLE_INDEX_BITS) - 1;
+const uint32_t MATERIAL_MAX_GENERATION = (1u << (32 - MATERIAL_HANDLE_INDEX_BITS)) - 1;
+
+bool LUNAMaterialRegistry::Key::operator==(const Key& key) const
+{
+	return texture == key.texture && shader == key.shader && blending == key.blending;
+}
+
+size_t LUNAMaterialRegistry::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<const void*>()(key.texture);
+	hash ^= std::hash<const void*>()(key.shader) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>()((int)key.blending) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+LUNAMaterialRegistry::LUNAMaterialRegistry()
+{
+	entries.resize(1);
+}
+
+bool LUNAMaterialRegistry::IsExpired(const Entry& entry) const
+{
+	return (entry.texturePtr && entry.texture.expired()) || (entry.shaderPtr && entry.shader.expired());
+}
+
+void LUNAMaterialRegistry::RemoveEntry(uint32_t index)
+{
+	Entry& entry = entries[index];
+
+	handles.erase({ entry.texturePtr, entry.shaderPtr, entry.blending });
+	entry.texture.reset();
+	entry.shader.reset();
+	entry.texturePtr = nullptr;
+	entry.shaderPtr = nullptr;
+	entry.used = false;
+
+	freeEntries.push_back(index);
+}
+
+// Remove all entries with expired texture or shader
+void LUNAMaterialRegistry::CollectExpired()
+{
+	for(size_t i = 1; i < entries.size(); i++)
+	{
+		if(entries[i].used && IsExpired(entries[i])) RemoveEntry(i);
+	}
+}
+
+// Get handle of material with given texture, shader and blending mode. Make new entry if needed
+uint32_t LUNAMaterialRegistry::Intern(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
+	LUNABlendingMode blending)
+{
+	auto sharedTexture = texture.lock();
+	auto sharedShader = shader.lock();
+	Key key = { sharedTexture.get(), sharedShader.get(), blending };
+
+	auto it = handles.find(key);
+	if(it != handles.end())
+	{
+		uint32_t index = it->second & MATERIAL_HANDLE_INDEX_MASK;
+		if(!IsExpired(entries[index])) return it->second;
+
+		// Texture or shader was deleted and new one was created at same address
+		RemoveEntry(index);
+	}
+
+	if(freeEntries.empty() && entries.size() % MATERIAL_COLLECT_PERIOD == 0) CollectExpired();
+
+	uint32_t index;
+	if(!freeEntries.empty())
+	{
+		index = freeEntries.back();
+		freeEntries.pop_back();
+
+		// Change generation to invalidate old handles of this entry
+		Entry& entry = entries[index];
+		entry.generation = entry.generation == MATERIAL_MAX_GENERATION ? 0 : entry.generation + 1;
+	}
+	else
+	{
+		if(entries.size() > MATERIAL_HANDLE_INDEX_MASK)
+		{
+			LUNA_LOGE("Too many unique materials");
+			return 0;
+		}
+
+		index = entries.size();
+		entries.emplace_back();
+	}
+
+	Entry& entry = entries[index];
+	entry.texture = sharedTexture;
+	entry.shader = sharedShader;
+	entry.blending = blending;
+	entry.texturePtr = sharedTexture.get();
+	entry.shaderPtr = sharedShader.get();
+	entry.used = true;
+
+	// Sort bits layout (from high to low bits): shader(16), texture(24), blending(8)
+	uint64_t shaderBits = sharedShader ? (uint64_t)(sharedShader->GetId() & 0xFFFF) : 0;
+	uint64_t textureBits = sharedTexture ? (uint64_t)(sharedTexture->GetId() & 0xFFFFFF) : 0;
+	entry.sortBits = (shaderBits << 32) | (textureBits << 8) | ((uint64_t)blending & 0xFF);
+
+	uint32_t handle = (entry.generation << MATERIAL_HANDLE_INDEX_BITS) | index;
+	handles[key] = handle;
+	return handle;
+}
+
+// Get entry for given handle. Returns nullptr for invalid or stale handle
+const LUNAMaterialRegistry::Entry* LUNAMaterialRegistry::Get(uint32_t handle) const
+{
+	uint32_t index = handle & MATERIAL_HANDLE_INDEX_MASK;
+	if(index == 0 || index >= entries.size()) return nullptr;
+
+	const Entry& entry = entries[index];
+	if(!entry.used || entry.generation != (handle >> MATERIAL_HANDLE_INDEX_BITS)) return nullptr;
+
+	return &entry;
+}
+
+// Get count of used entries
+int LUNAMaterialRegistry::GetCount() const
+{
+	return entries.size() - 1 - freeEntries.size();
+}
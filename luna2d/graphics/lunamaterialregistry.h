@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunatexture.h"
+#include "lunashader.h"
+#include "lunablendingmode.h"
+#include <unordered_map>
+
+namespace luna2d{
+
+const int MATERIAL_HANDLE_INDEX_BITS = 20; // Low bits of material handle are index of entry, high bits are generation of entry
+const int MATERIAL_COLLECT_PERIOD = 256; // Expired entries are collected each time when this count of new entries is added
+
+//---------------------------------------------------------------------
+// Registry of interned materials
+// Each unique combination of texture, shader and blending mode gets
+// small integer handle, so materials can be compared by one integer.
+// Entries with expired texture or shader are reused with new generation,
+// so stale handles don't resolve to another material
+//---------------------------------------------------------------------
+class LUNAMaterialRegistry
+{
+public:
+	struct Entry
+	{
+		std::weak_ptr<LUNATexture> texture;
+		std::weak_ptr<LUNAShader> shader;
+		LUNABlendingMode blending = LUNABlendingMode::ALPHA;
+		uint64_t sortBits = 0; // Shader, texture and blending bits for sort key of draw command
+		uint32_t generation = 0;
+		bool used = false;
+
+		// Pointers using only as key for lookup. Never dereferenced
+		const LUNATexture* texturePtr = nullptr;
+		const LUNAShader* shaderPtr = nullptr;
+	};
+
+	LUNAMaterialRegistry();
+
+private:
+	struct Key
+	{
+		const LUNATexture* texture;
+		const LUNAShader* shader;
+		LUNABlendingMode blending;
+
+		bool operator==(const Key& key) const;
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+private:
+	std::vector<Entry> entries; // First entry is reserved for invalid handle
+	std::vector<uint32_t> freeEntries;
+	std::unordered_map<Key, uint32_t, KeyHash> handles;
+
+private:
+	bool IsExpired(const Entry& entry) const;
+	void RemoveEntry(uint32_t index);
+
+	// Remove all entries with expired texture or shader
+	void CollectExpired();
+
+public:
+	// Get handle of material with given texture, shader and blending mode. Make new entry if needed
+	uint32_t Intern(const std::weak_ptr<LUNATexture>& texture, const std::weak_ptr<LUNAShader>& shader,
+		LUNABlendingMode blending);
+
+	// Get entry for given handle. Returns nullptr for invalid or stale handle
+	const Entry* Get(uint32_t handle) const;
+
+	// Get count of used entries
+	int GetCount() const;
+};
+
+}
@@ -37,9 +37,82 @@ LUNAMesh::LUNAMesh(const std::weak_ptr<LUNATexture>& texture)
 	SetTexture(texture);
 }
 
+void LUNAMesh::UploadBuffers()
+{
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+
+	if(!vertexBuffer)
+	{
+		vertexBuffer = std::unique_ptr<LUNABufferObject>(new LUNABufferObject(LUNABufferType::VERTEX, LUNABufferUsage::STATIC));
+		indexBuffer = std::unique_ptr<LUNABufferObject>(new LUNABufferObject(LUNABufferType::INDEX, LUNABufferUsage::STATIC));
+	}
+
+	// Buffers were lost with OpenGL context
+	else if(uploadedContextVersion != renderer->GetContextVersion())
+	{
+		vertexBuffer->Reload();
+		indexBuffer->Reload();
+	}
+
+	vertexBuffer->Bind();
+	if(renderer->IsPremultipliedAlpha() || material.GetBlending() == LUNABlendingMode::PREMULTIPLIED)
+	{
+		std::vector<LUNAVertex> premultiplied = vertexes;
+		renderer->PremultiplyVertexes(&premultiplied[0], premultiplied.size(), material.GetBlending());
+		vertexBuffer->SetData(&premultiplied[0], premultiplied.size() * sizeof(LUNAVertex));
+	}
+	else vertexBuffer->SetData(&vertexes[0], vertexes.size() * sizeof(LUNAVertex));
+	vertexBuffer->Unbind();
+
+	indexBuffer->Bind();
+	indexBuffer->SetData(&indexes[0], indexes.size() * sizeof(unsigned short));
+	indexBuffer->Unbind();
+
+	uploadedContextVersion = renderer->GetContextVersion();
+	needUpload = false;
+}
+
+// Check for all indexes refer to existing vertexes
+bool LUNAMesh::ValidateIndexes()
+{
+	for(unsigned short index : indexes)
+	{
+		if(index >= vertexes.size())
+		{
+			LUNA_LOGE("Mesh index %d is out of range of %d vertexes", (int)index, (int)vertexes.size());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool LUNAMesh::IsStatic()
+{
+	return staticMesh;
+}
+
+void LUNAMesh::SetStatic(bool staticMesh)
+{
+	this->staticMesh = staticMesh;
+	needUpload = true;
+
+	// Free GPU memory of dynamic mesh
+	if(!staticMesh)
+	{
+		vertexBuffer.reset();
+		indexBuffer.reset();
+	}
+}
+
 void LUNAMesh::Clear()
 {
 	vertexes.clear();
+	indexes.clear();
+	bounds = LUNARect();
+	needUpload = true;
+	checkIndexes = false;
+	validIndexes = true;
 }
 
 void LUNAMesh::SetTexture(const std::weak_ptr<LUNATexture>& texture)
@@ -50,7 +123,7 @@ void LUNAMesh::SetTexture(const std::weak_ptr<LUNATexture>& texture)
 		return;
 	}
 
-	material.texture = texture;
+	material.SetTexture(texture);
 }
 
 void LUNAMesh::SetShader(const std::weak_ptr<LUNAShader>& shader)
@@ -61,46 +134,81 @@ void LUNAMesh::SetShader(const std::weak_ptr<LUNAShader>& shader)
 		return;
 	}
 
-	material.shader = shader;
+	material.SetShader(shader);
 }
 
+// Add vertex of triangle
 void LUNAMesh::AddVertex(float x, float y, float r, float g, float b, float alpha, float u, float v)
 {
-	// Position
-	vertexes.push_back(x);
-	vertexes.push_back(y);
-
-	// Color
-	vertexes.push_back(r);
-	vertexes.push_back(g);
-	vertexes.push_back(b);
-	vertexes.push_back(alpha);
-
-	// Texture coordinates
-	vertexes.push_back(u);
-	vertexes.push_back(v);
+	AddIndex(vertexes.size());
+	AddIndexedVertex(x, y, r, g, b, alpha, u, v);
+}
+
+// Add vertex without index
+void LUNAMesh::AddIndexedVertex(float x, float y, float r, float g, float b, float alpha, float u, float v)
+{
+	if(vertexes.size() >= RENDER_MAX_BATCH_VERTEXES) LUNA_RETURN_ERR("Mesh exceeds max count of vertexes");
+
+	if(vertexes.empty()) bounds = LUNARect(x, y, 0, 0);
+	else
+	{
+		float right = std::max(bounds.x + bounds.width, x);
+		float top = std::max(bounds.y + bounds.height, y);
+		bounds.x = std::min(bounds.x, x);
+		bounds.y = std::min(bounds.y, y);
+		bounds.width = right - bounds.x;
+		bounds.height = top - bounds.y;
+	}
+
+	vertexes.emplace_back(x, y, r, g, b, alpha, u, v);
+	needUpload = true;
+	checkIndexes = true;
+}
+
+// Add index of vertex added by "AddIndexedVertex"
+void LUNAMesh::AddIndex(int index)
+{
+	if(index < 0 || index >= RENDER_MAX_BATCH_VERTEXES) LUNA_RETURN_ERR("Invalid mesh index %d", index);
+
+	indexes.push_back((unsigned short)index);
+	needUpload = true;
+	checkIndexes = true;
 }
 
 void LUNAMesh::AddQuad(float x, float y, float width, float height, float u1, float v1, float u2, float v2,
 	const LUNAColor& color, float alpha)
 {
 	// Make quad from two triangles like:
-	// 2-3 5
-	// |/ /|
-	// 1 4-6
-
-	AddVertex(x, y, color.r, color.g, color.b, alpha, u1, v2); // 1
-	AddVertex(x, y + height, color.r, color.g, color.b, alpha, u1, v1); // 2
-	AddVertex(x + width, y + height, color.r, color.g, color.b, alpha, u2, v1); // 3
-
-	AddVertex(x, y, color.r, color.g, color.b, alpha, u1, v2); // 4
-	AddVertex(x + width, y + height, color.r, color.g, color.b, alpha, u2, v1); // 5
-	AddVertex(x + width, y, color.r, color.g, color.b, alpha, u2, v2); // 6
+	// 2-3
+	// |/|
+	// 1-4
+
+	// Don't add part of quad when mesh is full
+	if(vertexes.size() + 4 > RENDER_MAX_BATCH_VERTEXES) LUNA_RETURN_ERR("Mesh exceeds max count of vertexes");
+
+	int index = vertexes.size();
+	AddIndex(index);
+	AddIndex(index + 1);
+	AddIndex(index + 2);
+	AddIndex(index);
+	AddIndex(index + 2);
+	AddIndex(index + 3);
+
+	AddIndexedVertex(x, y, color.r, color.g, color.b, alpha, u1, v2); // 1
+	AddIndexedVertex(x, y + height, color.r, color.g, color.b, alpha, u1, v1); // 2
+	AddIndexedVertex(x + width, y + height, color.r, color.g, color.b, alpha, u2, v1); // 3
+	AddIndexedVertex(x + width, y, color.r, color.g, color.b, alpha, u2, v2); // 4
 }
 
 void LUNAMesh::Render()
 {
-	if(material.texture.expired())
+	RenderWithOffset(glm::vec2());
+}
+
+// Render mesh moved by given offset without rebuilding vertexes
+void LUNAMesh::RenderWithOffset(const glm::vec2& offset)
+{
+	if(!material.IsValid())
 	{
 		LUNA_LOGE("Attempt to render invalid mesh");
 		return;
@@ -109,6 +217,36 @@ void LUNAMesh::Render()
 	// Do not draw empty mesh
 	if(vertexes.size() == 0) return;
 
+	// Invalid indexes would read vertexes of other objects in batch or out of vertex buffer
+	if(checkIndexes)
+	{
+		validIndexes = ValidateIndexes();
+		checkIndexes = false;
+	}
+	if(!validIndexes) return;
+
 	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
-	renderer->RenderVertexArray(vertexes, &material);
+	if(!renderer->IsVisible(LUNARect(bounds.x + offset.x, bounds.y + offset.y, bounds.width, bounds.height))) return;
+
+	// Static mesh is drawn from own buffers when vertex buffers are used by renderer
+	if(staticMesh && renderer->IsEnabledVertexBuffers() && !indexes.empty())
+	{
+		if(needUpload || uploadedContextVersion != renderer->GetContextVersion()) UploadBuffers();
+		renderer->RenderBuffers(vertexBuffer.get(), indexBuffer.get(), vertexes.size(), indexes.size(), &material, offset);
+		return;
+	}
+
+	if(offset.x == 0 && offset.y == 0)
+	{
+		renderer->RenderVertexArray(vertexes, indexes, &material);
+		return;
+	}
+
+	movedVertexes = vertexes;
+	for(auto& vertex : movedVertexes)
+	{
+		vertex.x += offset.x;
+		vertex.y += offset.y;
+	}
+	renderer->RenderVertexArray(movedVertexes, indexes, &material);
 }
@@ -24,7 +24,10 @@
 #pragma once
 
 #include "lunamaterial.h"
+#include "lunavertex.h"
+#include "lunabufferobject.h"
 #include "lunalua.h"
+#include "lunarect.h"
 
 namespace luna2d{
 
@@ -38,16 +41,41 @@ public:
 
 private:
 	LUNAMaterial material;
-	std::vector<float> vertexes;
+	std::vector<LUNAVertex> vertexes;
+	std::vector<unsigned short> indexes;
+	LUNARect bounds; // Bounding rect of all vertexes
+
+	// Indexes are checked against count of vertexes before rendering,
+	// because they can be added before their vertexes
+	bool checkIndexes = false;
+	bool validIndexes = true;
+
+	// Static mesh is uploaded to own buffers once and drawn from them directly
+	// Buffers are uploaded again only after mesh is modified
+	bool staticMesh = false;
+	bool needUpload = true;
+	int uploadedContextVersion = 0;
+	std::unique_ptr<LUNABufferObject> vertexBuffer, indexBuffer;
+
+	std::vector<LUNAVertex> movedVertexes; // Vertexes moved by render offset when buffers aren't used
+
+private:
+	void UploadBuffers();
+	bool ValidateIndexes(); // Check for all indexes refer to existing vertexes
 
 public:
+	bool IsStatic();
+	void SetStatic(bool staticMesh);
 	void Clear();
 	void SetTexture(const std::weak_ptr<LUNATexture>& texture);
 	void SetShader(const std::weak_ptr<LUNAShader>& shader);
-	void AddVertex(float x, float y, float r, float g, float b, float alpha, float u, float v);
+	void AddVertex(float x, float y, float r, float g, float b, float alpha, float u, float v); // Add vertex of triangle
+	void AddIndexedVertex(float x, float y, float r, float g, float b, float alpha, float u, float v); // Add vertex without index
+	void AddIndex(int index); // Add index of vertex added by "AddIndexedVertex"
 	void AddQuad(float x, float y, float width, float height, float u1, float v1, float u2, float v2,
 		const LUNAColor& color, float alpha);
 	void Render();
+	void RenderWithOffset(const glm::vec2& offset); // Render mesh moved by given offset without rebuilding vertexes
 };
 
 }
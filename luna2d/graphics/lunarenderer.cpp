@@ -24,40 +24,482 @@
 #include "lunarenderer.h"
 #include "lunagraphics.h"
 #include "lunasizes.h"
+#include "lunaconfig.h"
 #include "lunalog.h"
 #include "lunaassets.h"
 #include "lunaimage.h"
+#include "lunaintersect.h"
 
 using namespace luna2d;
 
-LUNARenderer::LUNARenderer()
+LUNARenderer::LUNARenderer() :
+	renderQueue(&materialRegistry),
+	workerPool(LUNAWorkerPool::GetDefaultThreadsCount())
 {
 	// Initialize batch vertex array
-	vertexBatch.reserve(RENDER_RESERVE_BATCH * RENDER_ELEMENT_PER_VERTEX);
+	vertexBatch.reserve(RENDER_RESERVE_BATCH);
+
+	indexBatch.reserve(RENDER_RESERVE_BATCH);
+
+	// Initialize ring of vertex and index buffers
+	for(int i = 0; i < RENDER_VERTEX_BUFFERS_COUNT; i++)
+	{
+		vertexBuffers.push_back(std::unique_ptr<LUNABufferObject>(
+			new LUNABufferObject(LUNABufferType::VERTEX, LUNABufferUsage::STREAM)));
+		indexBuffers.push_back(std::unique_ptr<LUNABufferObject>(
+			new LUNABufferObject(LUNABufferType::INDEX, LUNABufferUsage::STREAM)));
+		extraBuffers.push_back(std::unique_ptr<LUNABufferObject>(
+			new LUNABufferObject(LUNABufferType::VERTEX, LUNABufferUsage::STREAM)));
+	}
+
+	quadIndexBuffer = std::unique_ptr<LUNABufferObject>(new LUNABufferObject(LUNABufferType::INDEX, LUNABufferUsage::STATIC));
+
+	premultipliedAlpha = LUNAEngine::Shared()->GetConfig()->premultipliedAlpha;
+
+	GLint depthBits = 0;
+	glGetIntegerv(GL_DEPTH_BITS, &depthBits);
+	hasDepthBuffer = depthBits > 0;
 
 	// Initialize default shaders
 	defaultShader = std::make_shared<LUNAShader>(DEFAULT_VERT_SHADER, DEFAULT_FRAG_SHADER);
 	primitivesShader = std::make_shared<LUNAShader>(PRIMITIVES_VERT_SHADER, PRIMITIVES_FRAG_SHADER);
-	fontShader = std::make_shared<LUNAShader>(FONT_VERT_SHADER, FONT_FRAG_SHADER);
+	fontShader = std::make_shared<LUNAShader>(FONT_VERT_SHADER, premultipliedAlpha ? FONT_PREMULTIPLIED_FRAG_SHADER : FONT_FRAG_SHADER);
+	multiTextureShader = std::make_shared<LUNAShader>(MULTITEXTURE_VERT_SHADER, MULTITEXTURE_FRAG_SHADER);
 
 	SetDefaultViewport();
 }
 
-void LUNARenderer::SetVertex(float u, float v, float x, float y, const LUNAColor& color)
+// Make source of distance field font shader with given edge threshold in 0-255 range
+std::string LUNARenderer::MakeSdfFontSource(int threshold)
+{
+	std::string defines = "#define SDF_THRESHOLD " + std::to_string(threshold / 255.0f) + "\n";
+	if(premultipliedAlpha) defines += "#define PREMULTIPLIED_ALPHA\n";
+
+	return defines + FONT_SDF_FRAG_SHADER;
+}
+
+// Make source of vertex shader variant writing depth from "a_depth" attribute
+std::string LUNARenderer::MakeDepthSource(const std::string& vertexSource)
+{
+	return "#define DEPTH_PASS\n" + vertexSource;
+}
+
+// Get variant of given default shader writing depth. Custom shaders are returned as is
+// Variants are made on first use, so shaders used without opaque pass don't declare or compute depth
+std::shared_ptr<LUNAShader> LUNARenderer::GetDepthShader(const std::shared_ptr<LUNAShader>& shader)
+{
+	if(shader == defaultShader)
+	{
+		if(!defaultDepthShader) defaultDepthShader = std::make_shared<LUNAShader>(MakeDepthSource(DEFAULT_VERT_SHADER), DEFAULT_FRAG_SHADER);
+		return defaultDepthShader;
+	}
+
+	if(shader == fontShader)
+	{
+		if(!fontDepthShader) fontDepthShader = std::make_shared<LUNAShader>(MakeDepthSource(FONT_VERT_SHADER),
+			premultipliedAlpha ? FONT_PREMULTIPLIED_FRAG_SHADER : FONT_FRAG_SHADER);
+		return fontDepthShader;
+	}
+
+	if(shader == multiTextureShader)
+	{
+		if(!multiTextureDepthShader) multiTextureDepthShader = std::make_shared<LUNAShader>(
+			MakeDepthSource(MULTITEXTURE_VERT_SHADER), MULTITEXTURE_FRAG_SHADER);
+		return multiTextureDepthShader;
+	}
+
+	for(auto& entry : sdfFontShaders)
+	{
+		if(entry.second != shader) continue;
+
+		auto& depthShader = sdfFontDepthShaders[entry.first];
+		if(!depthShader) depthShader = std::make_shared<LUNAShader>(MakeDepthSource(FONT_VERT_SHADER), MakeSdfFontSource(entry.first));
+		return depthShader;
+	}
+
+	return shader;
+}
+
+// Upload vertex batch to next buffer in ring and bind it
+// Returns pointer to vertex data for setting attributes. It's nullptr when vertex buffers are used
+const LUNAVertex* LUNARenderer::BindVertexBatch(const std::vector<LUNAVertex>& batch)
+{
+	if(!useVertexBuffers) return &batch[0];
+
+	auto& buffer = vertexBuffers[curVertexBuffer];
+	curVertexBuffer = (curVertexBuffer + 1) % RENDER_VERTEX_BUFFERS_COUNT;
+
+	buffer->Bind();
+	buffer->SetData(&batch[0], batch.size() * sizeof(LUNAVertex));
+
+	return nullptr;
+}
+
+void LUNARenderer::UnbindVertexBatch()
+{
+	if(useVertexBuffers) LUNAGlState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Upload extra attributes of batch to next buffer in ring and bind it
+// Returns pointer to attribute data. It's nullptr when vertex buffers are used
+const LUNAVertexExtra* LUNARenderer::BindExtraBatch()
+{
+	// Vertexes added after last vertex with extra attributes get default ones
+	extraBatch.resize(vertexBatch.size());
+
+	if(!useVertexBuffers) return &extraBatch[0];
+
+	auto& buffer = extraBuffers[curExtraBuffer];
+	curExtraBuffer = (curExtraBuffer + 1) % RENDER_VERTEX_BUFFERS_COUNT;
+
+	buffer->Bind();
+	buffer->SetData(&extraBatch[0], extraBatch.size() * sizeof(LUNAVertexExtra));
+
+	return nullptr;
+}
+
+// Bind indexes for vertex batch. If batch contains only quads, shared quad indexes are used
+// Returns pointer to index data for draw call. It's nullptr when index buffers are used
+const unsigned short* LUNARenderer::BindIndexBatch(int& indexCount)
+{
+	// Batch contains only quads
+	if(indexBatch.empty())
+	{
+		size_t quadsCount = vertexBatch.size() / 4;
+		indexCount = quadsCount * 6;
+		MakeQuadIndexes(quadsCount);
+
+		if(!useVertexBuffers) return &quadIndexes[0];
+
+		quadIndexBuffer->Bind();
+		UploadQuadIndexes();
+
+		return nullptr;
+	}
+
+	indexCount = indexBatch.size();
+	if(!useVertexBuffers) return &indexBatch[0];
+
+	auto& buffer = indexBuffers[curIndexBuffer];
+	curIndexBuffer = (curIndexBuffer + 1) % RENDER_VERTEX_BUFFERS_COUNT;
+
+	buffer->Bind();
+	buffer->SetData(&indexBatch[0], indexBatch.size() * sizeof(unsigned short));
+
+	return nullptr;
+}
+
+void LUNARenderer::UnbindIndexBatch()
+{
+	if(useVertexBuffers) LUNAGlState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// Add indexes for quad with given first vertex to index batch
+void LUNARenderer::AddQuadIndexes(size_t firstVertex)
+{
+	unsigned short index = (unsigned short)firstVertex;
+
+	indexBatch.push_back(index);
+	indexBatch.push_back(index + 1);
+	indexBatch.push_back(index + 2);
+	indexBatch.push_back(index);
+	indexBatch.push_back(index + 2);
+	indexBatch.push_back(index + 3);
+}
+
+// Make shared quad indexes for at least given count of quads
+void LUNARenderer::MakeQuadIndexes(size_t quadsCount)
+{
+	size_t madeCount = quadIndexes.size() / 6;
+	if(quadsCount <= madeCount) return;
+
+	// Grow indexes at least twice to avoid frequent reuploading
+	quadsCount = std::min(std::max(quadsCount, madeCount * 2), (size_t)RENDER_MAX_BATCH_VERTEXES / 4);
+	quadIndexes.reserve(quadsCount * 6);
+
+	for(size_t i = madeCount; i < quadsCount; i++)
+	{
+		unsigned short index = (unsigned short)(i * 4);
+
+		quadIndexes.push_back(index);
+		quadIndexes.push_back(index + 1);
+		quadIndexes.push_back(index + 2);
+		quadIndexes.push_back(index);
+		quadIndexes.push_back(index + 2);
+		quadIndexes.push_back(index + 3);
+	}
+}
+
+// Upload shared quad indexes to bound quad index buffer if they were grown
+void LUNARenderer::UploadQuadIndexes()
+{
+	if(uploadedQuadIndexes >= quadIndexes.size()) return;
+
+	quadIndexBuffer->SetData(&quadIndexes[0], quadIndexes.size() * sizeof(unsigned short));
+	uploadedQuadIndexes = quadIndexes.size();
+}
+
+// Use given material for next geometry in batch. Renders batch if material can't be added to it
+// Returns texture slot of material in batch
+unsigned char LUNARenderer::UseMaterial(uint32_t material)
+{
+	if(material == curMaterial) return curSlot;
+
+	if(curMaterial != 0 && !AddTextureSlot(material)) RenderBatch(GetFlushReason(material));
+
+	// New batch
+	if(curMaterial == 0)
+	{
+		slotMaterials.push_back(material);
+		curSlot = 0;
+	}
+
+	curMaterial = material;
+	return curSlot;
+}
+
+// Get reason of flush when material of batch is changed to given material
+LUNAFlushReason LUNARenderer::GetFlushReason(uint32_t material)
+{
+	auto entry = materialRegistry.Get(material);
+	auto curEntry = materialRegistry.Get(curMaterial);
+
+	if(!entry || !curEntry || entry->shaderPtr != curEntry->shaderPtr) return LUNAFlushReason::SHADER;
+	if(!IsCompatibleBlending(entry->blending, curEntry->blending)) return LUNAFlushReason::BLENDING;
+	return LUNAFlushReason::TEXTURE;
+}
+
+// Try to add texture of given material to slots of current batch
+bool LUNARenderer::AddTextureSlot(uint32_t material)
 {
-	// Position
-	vertexBatch.push_back(x);
-	vertexBatch.push_back(y);
+	auto entry = materialRegistry.Get(material);
+	auto batchEntry = materialRegistry.Get(slotMaterials[0]);
+	if(!entry || !batchEntry || !IsCompatibleBlending(entry->blending, batchEntry->blending)) return false;
+	if(entry->shaderPtr != batchEntry->shaderPtr) return false;
 
-	// Color
-	vertexBatch.push_back(color.r);
-	vertexBatch.push_back(color.g);
-	vertexBatch.push_back(color.b);
-	vertexBatch.push_back(color.a);
+	// Material differs from slot material only by compatible blending mode
+	for(size_t i = 0; i < slotMaterials.size(); i++)
+	{
+		auto slotEntry = materialRegistry.Get(slotMaterials[i]);
+		if(slotEntry && slotEntry->texturePtr == entry->texturePtr)
+		{
+			curSlot = (unsigned char)i;
+			return true;
+		}
+	}
+
+	// Only geometry with default shader can use several texture slots
+	if(!multiTexture || entry->shaderPtr != defaultShader.get()) return false;
+	if(slotMaterials.size() >= RENDER_TEXTURE_SLOTS) return false;
 
-	// Texture coordinates
-	vertexBatch.push_back(u);
-	vertexBatch.push_back(v);
+	curSlot = (unsigned char)slotMaterials.size();
+	slotMaterials.push_back(material);
+	return true;
+}
+
+// Check for geometry with given blending modes can be rendered in one batch
+// With premultiplied alpha additive blending is expressed per vertex, so it shares batch with alpha blending
+bool LUNARenderer::IsCompatibleBlending(LUNABlendingMode blending1, LUNABlendingMode blending2)
+{
+	if(blending1 == blending2) return true;
+	return premultipliedAlpha && blending1 != LUNABlendingMode::NONE && blending2 != LUNABlendingMode::NONE;
+}
+
+// Set extra attributes and premultiply colors of vertexes added to batch starting from given vertex
+// Extra attributes are stored only since first vertex which needs them
+void LUNARenderer::PrepareBatchVertexes(size_t firstVertex, unsigned char slot, uint32_t material)
+{
+	if(slot != 0 || batchDepth != 0)
+	{
+		extraBatch.resize(vertexBatch.size());
+		for(size_t i = firstVertex; i < vertexBatch.size(); i++)
+		{
+			extraBatch[i].slot = slot;
+			extraBatch[i].depth = batchDepth;
+		}
+	}
+
+	auto entry = materialRegistry.Get(material);
+	PremultiplyVertexes(&vertexBatch[firstVertex], vertexBatch.size() - firstVertex,
+		entry ? entry->blending : LUNABlendingMode::ALPHA);
+}
+
+// Add quads to batch. Each quad is 4 consecutive vertexes
+void LUNARenderer::BatchQuads(const LUNAVertex* quads, size_t quadsCount, uint32_t material)
+{
+	while(quadsCount > 0)
+	{
+		if(vertexBatch.size() + 4 > RENDER_MAX_BATCH_VERTEXES) RenderBatch(LUNAFlushReason::BATCH_FULL);
+
+		unsigned char slot = UseMaterial(material);
+		size_t count = std::min(quadsCount, (RENDER_MAX_BATCH_VERTEXES - vertexBatch.size()) / 4);
+		size_t firstVertex = vertexBatch.size();
+
+		// Batch already contains custom geometry, so quad indexes should be added explicitly
+		if(!indexBatch.empty())
+		{
+			for(size_t i = 0; i < count; i++) AddQuadIndexes(firstVertex + i * 4);
+		}
+
+		vertexBatch.insert(vertexBatch.end(), quads, quads + count * 4);
+		PrepareBatchVertexes(firstVertex, slot, material);
+
+		quads += count * 4;
+		quadsCount -= count;
+	}
+}
+
+// Add triangles to batch. Indexes are relative to first given vertex
+void LUNARenderer::BatchVertexes(const LUNAVertex* vertexes, size_t vertexCount,
+	const unsigned short* indexes, size_t indexCount, uint32_t material)
+{
+	if(vertexBatch.size() + vertexCount > RENDER_MAX_BATCH_VERTEXES) RenderBatch(LUNAFlushReason::BATCH_FULL);
+
+	unsigned char slot = UseMaterial(material);
+
+	// If batch contains only quads, make indexes for them before adding custom geometry
+	if(indexBatch.empty())
+	{
+		for(size_t i = 0; i < vertexBatch.size(); i += 4) AddQuadIndexes(i);
+	}
+
+	unsigned short firstVertex = (unsigned short)vertexBatch.size();
+	vertexBatch.insert(vertexBatch.end(), vertexes, vertexes + vertexCount);
+	for(size_t i = 0; i < indexCount; i++) indexBatch.push_back(firstVertex + indexes[i]);
+
+	PrepareBatchVertexes(firstVertex, slot, material);
+}
+
+// Sort deferred draw commands and add them to batch
+void LUNARenderer::FlushRenderQueue()
+{
+	if(renderQueue.IsEmpty()) return;
+
+	// Commands are deferred without sorting when only opaque pass is enabled
+	if(sortRender) savedRenderCalls += renderQueue.Sort();
+	else renderQueue.KeepOrder();
+
+	if(IsOpaquePassActive()) FlushDepthPasses();
+	else
+	{
+		for(int index : renderQueue.GetOrder()) BatchCommand(index);
+	}
+
+	renderQueue.Clear();
+}
+
+// Add deferred command with given index to batch
+void LUNARenderer::BatchCommand(int index)
+{
+	const auto& command = renderQueue.GetCommand(index);
+	const LUNAVertex* vertexes = renderQueue.GetVertexes(command);
+
+	if(command.indexCount == 0) BatchQuads(vertexes, 1, command.material);
+	else BatchVertexes(vertexes, command.vertexCount, renderQueue.GetIndexes(command), command.indexCount, command.material);
+}
+
+// Opaque pass is used only for default framebuffer, because framebuffer objects have no depth attachment
+bool LUNARenderer::IsOpaquePassActive()
+{
+	return opaquePass && !frameBuffer;
+}
+
+// Check for geometry with given material can be rendered with depth
+bool LUNARenderer::HasDepth(uint32_t material)
+{
+	auto entry = materialRegistry.Get(material);
+	auto shader = entry ? entry->shader.lock() : nullptr;
+	if(!shader) return false;
+
+	// Default shaders have variants writing depth. Custom shader can read depth by declaring "a_depth" attribute
+	return GetDepthShader(shader) != shader || shader->HasDepthAttribute();
+}
+
+// Render deferred commands in opaque and blended passes
+// Shaders without depth attribute can't be depth tested, so commands with such shaders split order into segments
+// and are rendered between them without depth test
+void LUNARenderer::FlushDepthPasses()
+{
+	const auto& order = renderQueue.GetOrder();
+	size_t count = order.size();
+	size_t segmentBegin = 0;
+
+	for(size_t i = 0; i <= count; i++)
+	{
+		bool barrier = i < count && !HasDepth(renderQueue.GetCommand(order[i]).material);
+		if(i < count && !barrier) continue;
+
+		RenderDepthSegment(segmentBegin, i);
+
+		if(barrier)
+		{
+			SetDepthPass(LUNADepthPass::NONE);
+			BatchCommand(order[i]);
+		}
+
+		segmentBegin = i + 1;
+	}
+
+	depthCommands += count;
+}
+
+// Render commands in given range of order. Opaque commands are rendered front to back, then blended back to front
+// Each command is nearer than all commands before it in order, so blended geometry is hidden only by geometry drawn after it
+void LUNARenderer::RenderDepthSegment(size_t first, size_t last)
+{
+	const auto& order = renderQueue.GetOrder();
+
+	for(size_t i = last; i > first; i--)
+	{
+		const auto& command = renderQueue.GetCommand(order[i - 1]);
+		auto entry = materialRegistry.Get(command.material);
+		if(!entry || entry->blending != LUNABlendingMode::NONE) continue;
+
+		SetDepthPass(LUNADepthPass::OPAQUE);
+		batchDepth = (unsigned short)std::max(RENDER_MAX_DEPTH - depthCommands - (int)(i - 1), 1);
+		BatchCommand(order[i - 1]);
+	}
+
+	for(size_t i = first; i < last; i++)
+	{
+		const auto& command = renderQueue.GetCommand(order[i]);
+		auto entry = materialRegistry.Get(command.material);
+		if(entry && entry->blending == LUNABlendingMode::NONE) continue;
+
+		SetDepthPass(LUNADepthPass::BLENDED);
+		batchDepth = (unsigned short)std::max(RENDER_MAX_DEPTH - depthCommands - (int)i, 1);
+		BatchCommand(order[i]);
+	}
+
+	batchDepth = 0;
+}
+
+// Switch depth state. Renders current batch if state is changed
+void LUNARenderer::SetDepthPass(LUNADepthPass pass)
+{
+	if(pass == depthPass) return;
+
+	RenderBatch(LUNAFlushReason::DEPTH_PASS);
+
+	switch(pass)
+	{
+	case LUNADepthPass::NONE:
+		glDisable(GL_DEPTH_TEST);
+		glDepthMask(GL_TRUE); // Depth writing should be enabled for clearing depth buffer
+		break;
+	case LUNADepthPass::OPAQUE:
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LESS); // Nearer command is rendered first, so it wins when depth is clamped
+		glDepthMask(GL_TRUE);
+		break;
+	case LUNADepthPass::BLENDED:
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LEQUAL);
+		glDepthMask(GL_FALSE);
+		break;
+	}
+
+	depthPass = pass;
 }
 
 bool LUNARenderer::IsInProgress()
@@ -65,6 +507,12 @@ bool LUNARenderer::IsInProgress()
 	return inProgress;
 }
 
+// Get index of current frame
+unsigned int LUNARenderer::GetFrameIndex()
+{
+	return frameIndex;
+}
+
 int LUNARenderer::GetRenderCalls()
 {
 	return renderCalls;
@@ -75,6 +523,22 @@ int LUNARenderer::GetRenderedVertexes()
 	return renderedVertexes;
 }
 
+int LUNARenderer::GetSavedRenderCalls()
+{
+	return savedRenderCalls;
+}
+
+int LUNARenderer::GetCulledObjects()
+{
+	return culledObjects;
+}
+
+// Get stats of batch flushes on last rendered frame
+const LUNARenderStats& LUNARenderer::GetRenderStats()
+{
+	return renderStats;
+}
+
 std::shared_ptr<LUNAShader> LUNARenderer::GetDefaultShader()
 {
 	return defaultShader;
@@ -90,6 +554,52 @@ std::shared_ptr<LUNAShader> LUNARenderer::GetFontShader()
 	return fontShader;
 }
 
+// Get shader for distance field fonts with given edge threshold. Fonts with same threshold share shader
+std::shared_ptr<LUNAShader> LUNARenderer::GetSdfFontShader(float threshold)
+{
+	int key = std::min(std::max(threshold, 0.0f), 1.0f) * 255.0f + 0.5f;
+
+	auto& shader = sdfFontShaders[key];
+	if(!shader) shader = std::make_shared<LUNAShader>(FONT_VERT_SHADER, MakeSdfFontSource(key));
+
+	return shader;
+}
+
+LUNAMaterialRegistry* LUNARenderer::GetMaterialRegistry()
+{
+	return &materialRegistry;
+}
+
+int LUNARenderer::GetContextVersion()
+{
+	return contextVersion;
+}
+
+bool LUNARenderer::IsPremultipliedAlpha()
+{
+	return premultipliedAlpha;
+}
+
+// Premultiply colors of given vertexes when premultiplied alpha mode is enabled
+// or when vertexes use premultiplied blending mode
+// Additive vertexes get zero alpha, so they add color without covering background
+void LUNARenderer::PremultiplyVertexes(LUNAVertex* vertexes, size_t count, LUNABlendingMode blending)
+{
+	if(blending == LUNABlendingMode::NONE) return;
+	if(!premultipliedAlpha && blending != LUNABlendingMode::PREMULTIPLIED) return;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		LUNAVertex& vertex = vertexes[i];
+		unsigned int alpha = vertex.a;
+
+		vertex.r = (unsigned char)((vertex.r * alpha + 127) / 255);
+		vertex.g = (unsigned char)((vertex.g * alpha + 127) / 255);
+		vertex.b = (unsigned char)((vertex.b * alpha + 127) / 255);
+		if(blending == LUNABlendingMode::ADDITIVE) vertex.a = 0;
+	}
+}
+
 LUNAColor LUNARenderer::GetBackgroundColor()
 {
 	return backColor;
@@ -107,7 +617,7 @@ void LUNARenderer::SetCamera(const std::shared_ptr<LUNACamera>& camera)
 
 void LUNARenderer::EnableScissor(float x, float y, float width, float height)
 {
-	Render();
+	Render(LUNAFlushReason::SCISSOR);
 
 	const auto& camera = LUNAEngine::SharedGraphics()->GetCamera();
 	auto pos = camera->Project(glm::vec2(x, y));
@@ -121,14 +631,19 @@ void LUNARenderer::EnableScissor(float x, float y, float width, float height)
 
 void LUNARenderer::DisableScissor()
 {
-	Render();
+	Render(LUNAFlushReason::SCISSOR);
 
 	glDisable(GL_SCISSOR_TEST);
 }
 
+std::shared_ptr<LUNAFrameBuffer> LUNARenderer::GetFrameBuffer()
+{
+	return frameBuffer;
+}
+
 void LUNARenderer::SetFrameBuffer(const std::shared_ptr<LUNAFrameBuffer>& frameBuffer)
 {
-	if(inProgress) Render();
+	if(inProgress) Render(LUNAFlushReason::FRAME_BUFFER);
 
 	if(this->frameBuffer) this->frameBuffer->Unbind();
 	if(frameBuffer) frameBuffer->Bind();
@@ -142,7 +657,7 @@ void LUNARenderer::SetDefaultViewport()
 }
 
 // Read screen pixels into instance of "LUNAImage"
-std::shared_ptr<LUNAImage> LUNARenderer::ReadPixels()
+std::shared_ptr<LUNAImage> LUNARenderer::ReadPixels(bool flip)
 {
 	int viewport[4];
 	glGetIntegerv(GL_VIEWPORT, viewport);
@@ -154,8 +669,8 @@ std::shared_ptr<LUNAImage> LUNARenderer::ReadPixels()
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &data[0]);
 
-	auto image = std::make_shared<LUNAImage>(width, height, LUNAColorType::RGB, data);
-	image->FlipVertically();
+	auto image = std::make_shared<LUNAImage>(width, height, LUNAColorType::RGB, std::move(data));
+	if(flip) image->FlipVertically();
 	return image;
 }
 
@@ -169,6 +684,114 @@ void LUNARenderer::EnableDebugRender(bool enable)
 	debugRender = enable;
 }
 
+bool LUNARenderer::IsEnabledVertexBuffers()
+{
+	return useVertexBuffers;
+}
+
+void LUNARenderer::EnableVertexBuffers(bool enable)
+{
+	if(inProgress) Render(LUNAFlushReason::SETTINGS);
+
+	useVertexBuffers = enable;
+}
+
+bool LUNARenderer::IsEnabledRenderSorting()
+{
+	return sortRender;
+}
+
+void LUNARenderer::EnableRenderSorting(bool enable)
+{
+	if(inProgress) Render(LUNAFlushReason::SETTINGS);
+
+	sortRender = enable;
+}
+
+int LUNARenderer::GetRenderLayer()
+{
+	return renderLayer;
+}
+
+void LUNARenderer::SetRenderLayer(int layer)
+{
+	renderLayer = layer;
+}
+
+bool LUNARenderer::IsEnabledMultiTexture()
+{
+	return multiTexture;
+}
+
+void LUNARenderer::EnableMultiTexture(bool enable)
+{
+	if(inProgress) Render(LUNAFlushReason::SETTINGS);
+
+	multiTexture = enable;
+}
+
+bool LUNARenderer::IsEnabledOpaquePass()
+{
+	return opaquePass;
+}
+
+void LUNARenderer::EnableOpaquePass(bool enable)
+{
+	if(enable && !hasDepthBuffer) LUNA_RETURN_ERR("Opaque pass requires depth buffer in default framebuffer");
+	if(inProgress) Render(LUNAFlushReason::SETTINGS);
+
+	opaquePass = enable;
+}
+
+bool LUNARenderer::IsEnabledCulling()
+{
+	return culling;
+}
+
+void LUNARenderer::EnableCulling(bool enable)
+{
+	culling = enable;
+}
+
+// Check for given bounding rect is visible by camera. Should be called by objects before making vertexes
+// Invisible objects are counted as culled
+bool LUNARenderer::IsVisible(const LUNARect& bounds)
+{
+	if(!culling || intersect::Rectangles(bounds, camera->GetViewRect())) return true;
+
+	culledObjects++;
+	return false;
+}
+
+// Same as "IsVisible", but doesn't count culled objects. Can be called from worker threads
+bool LUNARenderer::IsInView(const LUNARect& bounds)
+{
+	return !culling || intersect::Rectangles(bounds, camera->GetViewRect());
+}
+
+void LUNARenderer::AddCulledObjects(int count)
+{
+	culledObjects += count;
+}
+
+bool LUNARenderer::IsEnabledParallelBuild()
+{
+	return parallelBuild;
+}
+
+void LUNARenderer::EnableParallelBuild(bool enable)
+{
+	parallelBuild = enable;
+}
+
+// Split given count of items into ranges of "jobSize" items and run job for each range
+// Ranges are run on worker threads when parallel build is enabled
+void LUNARenderer::BuildParallel(size_t count, size_t jobSize, const LUNAWorkerJob& job)
+{
+	if(parallelBuild) workerPool.ParallelFor(count, jobSize, job);
+	else LUNAWorkerPool::SerialFor(count, jobSize, job);
+}
+
 void LUNARenderer::RenderQuad(
 	float x1, float y1, float u1, float v1,
 	float x2, float y2, float u2, float v2,
@@ -176,147 +799,359 @@ void LUNARenderer::RenderQuad(
 	float x4, float y4, float u4, float v4,
 	const LUNAMaterial* material, const LUNAColor& color)
 {
-	if(curMaterial && *curMaterial != *material) Render();
-	curMaterial = material;
-
 	// Make quad from two triangles like:
-	// 2-3 5
-	// |/ /|
-	// 1 4-6
+	// 2-3
+	// |/|
+	// 1-4
+	LUNAVertex quad[4] =
+	{
+		LUNAVertex(x1, y1, u1, v1, color), // 1
+		LUNAVertex(x2, y2, u2, v2, color), // 2
+		LUNAVertex(x3, y3, u3, v3, color), // 3
+		LUNAVertex(x4, y4, u4, v4, color) // 4
+	};
 
-	SetVertex(u1, v1, x1, y1, color); // 1
-	SetVertex(u2, v2, x2, y2, color); // 2
-	SetVertex(u3, v3, x3, y3, color); // 3
+	FlushLines();
 
-	SetVertex(u1, v1, x1, y1, color); // 4
-	SetVertex(u3, v3, x3, y3, color); // 5
-	SetVertex(u4, v4, x4, y4, color); // 6
+	if(sortRender || opaquePass) renderQueue.AddQuad(quad, material->GetHandle(), renderLayer);
+	else BatchQuads(quad, 1, material->GetHandle());
 
 	if(debugRender)
 	{
-		RenderLine(x1, y1, x2, y2, color); // 1-2
-		RenderLine(x1, y1, x3, y3, color); // 1-3
-		RenderLine(x2, y2, x3, y3, color); // 2-3
-		RenderLine(x1, y1, x4, y4, color); // 4-6
-		RenderLine(x3, y3, x4, y4, color); // 5-6
+		RenderDebugLine(x1, y1, x2, y2, color); // 1-2
+		RenderDebugLine(x1, y1, x3, y3, color); // 1-3
+		RenderDebugLine(x2, y2, x3, y3, color); // 2-3
+		RenderDebugLine(x1, y1, x4, y4, color); // 1-4
+		RenderDebugLine(x3, y3, x4, y4, color); // 3-4
 	}
 }
 
-void LUNARenderer::RenderVertexArray(std::vector<float>& vertexes, const LUNAMaterial* material)
+// Render quads from given vertexes. Each quad is 4 consecutive vertexes in same order as in "RenderQuad"
+void LUNARenderer::RenderQuads(const LUNAVertex* quads, size_t quadsCount, const LUNAMaterial* material)
 {
-	if(curMaterial && *curMaterial != *material) Render();
-	curMaterial = material;
+	FlushLines();
 
-	vertexBatch.insert(vertexBatch.end(), vertexes.begin(), vertexes.end());
+	if(sortRender || opaquePass)
+	{
+		for(size_t i = 0; i < quadsCount; i++) renderQueue.AddQuad(quads + i * 4, material->GetHandle(), renderLayer);
+	}
+	else BatchQuads(quads, quadsCount, material->GetHandle());
 
 	if(debugRender)
 	{
-		int count = vertexes.size();
-		for(int i = 0; i < count; i += RENDER_ELEMENT_PER_VERTEX * 3)
+		for(size_t i = 0; i < quadsCount * 4; i += 4)
 		{
-			float x1 = vertexes[i];
-			float y1 = vertexes[i + 1];
-			float x2 = vertexes[i + RENDER_ELEMENT_PER_VERTEX];
-			float y2 = vertexes[i + RENDER_ELEMENT_PER_VERTEX + 1];
-			float x3 = vertexes[i + RENDER_ELEMENT_PER_VERTEX * 2];
-			float y3 = vertexes[i + RENDER_ELEMENT_PER_VERTEX * 2 + 1];
-
-			RenderLine(x1, y1, x2, y2, LUNAColor::WHITE);
-			RenderLine(x1, y1, x3, y3, LUNAColor::WHITE);
-			RenderLine(x2, y2, x3, y3, LUNAColor::WHITE);
+			const LUNAVertex* quad = quads + i;
+			LUNAColor color = LUNAColor::WHITE;
+
+			RenderDebugLine(quad[0].x, quad[0].y, quad[1].x, quad[1].y, color); // 1-2
+			RenderDebugLine(quad[0].x, quad[0].y, quad[2].x, quad[2].y, color); // 1-3
+			RenderDebugLine(quad[1].x, quad[1].y, quad[2].x, quad[2].y, color); // 2-3
+			RenderDebugLine(quad[0].x, quad[0].y, quad[3].x, quad[3].y, color); // 1-4
+			RenderDebugLine(quad[2].x, quad[2].y, quad[3].x, quad[3].y, color); // 3-4
 		}
 	}
 }
 
-void LUNARenderer::RenderLine(float x1, float y1, float x2, float y2, const LUNAColor& color)
+// Render triangles from given vertexes. Indexes are relative to first vertex in given array
+void LUNARenderer::RenderVertexArray(const std::vector<LUNAVertex>& vertexes, const std::vector<unsigned short>& indexes,
+	const LUNAMaterial* material)
+{
+	if(indexes.empty()) return;
+	if(vertexes.size() > RENDER_MAX_BATCH_VERTEXES) LUNA_RETURN_ERR("Vertex array exceeds max count of vertexes in batch");
+
+	FlushLines();
+
+	if(sortRender || opaquePass) renderQueue.AddVertexArray(vertexes, indexes, material->GetHandle(), renderLayer);
+	else BatchVertexes(&vertexes[0], vertexes.size(), &indexes[0], indexes.size(), material->GetHandle());
+
+	if(debugRender)
+	{
+		int count = indexes.size();
+		for(int i = 0; i + 2 < count; i += 3)
+		{
+			const LUNAVertex& vertex1 = vertexes[indexes[i]];
+			const LUNAVertex& vertex2 = vertexes[indexes[i + 1]];
+			const LUNAVertex& vertex3 = vertexes[indexes[i + 2]];
+
+			RenderDebugLine(vertex1.x, vertex1.y, vertex2.x, vertex2.y, LUNAColor::WHITE);
+			RenderDebugLine(vertex1.x, vertex1.y, vertex3.x, vertex3.y, LUNAColor::WHITE);
+			RenderDebugLine(vertex2.x, vertex2.y, vertex3.x, vertex3.y, LUNAColor::WHITE);
+		}
+	}
+}
+
+// Render triangles from given vertex and index buffers without batching
+// Vertex buffer should contain vertexes in "LUNAVertex" format. Vertexes are scaled and moved by given offset in shader
+// If color is given, it's used for all vertexes instead of their colors
+void LUNARenderer::RenderBuffers(LUNABufferObject* vertexBuffer, LUNABufferObject* indexBuffer, int vertexCount, int indexCount,
+	const LUNAMaterial* material, const glm::vec2& offset, const glm::vec2& scale, const LUNAColor* color)
 {
-	Render();
-	curMaterial = nullptr;
-	int vertexCount = 2;
+	// Keep order with geometry rendered before
+	Render(LUNAFlushReason::STATIC_MESH);
+
+	auto entry = materialRegistry.Get(material->GetHandle());
+	auto shader = entry ? entry->shader.lock() : nullptr;
+	auto texture = entry ? entry->texture.lock() : nullptr;
+	if(!shader || !texture) LUNA_RETURN_ERR("Attempt to render buffers with invalid material");
+
+	SetBlendingMode(entry->blending);
 
-	// Position
-	vertexBatch =
+	shader->Bind();
+	vertexBuffer->Bind();
+	shader->SetPositionAttribute(nullptr);
+	shader->SetTexCoordsAttribute(nullptr);
+
+	if(color)
 	{
-		x1, y1,
-		color.r, color.g, color.b, color.a,
-		0, 0, // Unused texture coords
-		x2, y2,
-		color.r, color.g, color.b, color.a,
-		0, 0, // Unused texture coords
-	};
+		// Constant color isn't premultiplied with vertexes, so it's premultiplied here
+		LUNAVertex colorVertex(0, 0, 0, 0, *color);
+		PremultiplyVertexes(&colorVertex, 1, entry->blending);
+		shader->SetColorConstant(colorVertex.r / 255.0f, colorVertex.g / 255.0f, colorVertex.b / 255.0f, colorVertex.a / 255.0f);
+	}
+	else shader->SetColorAttribute(nullptr);
 
-	primitivesShader->Bind();
-	primitivesShader->SetPositionAttribute(vertexBatch);
-	primitivesShader->SetColorAttribute(vertexBatch);
-	primitivesShader->SetTransformMatrix(camera->GetMatrix());
-	glDrawArrays(GL_LINES, 0, vertexCount);
+	// Transformed matrix has no version, so it's always uploaded
+	if(offset == glm::vec2() && scale == glm::vec2(1.0f)) shader->SetTransformMatrix(camera->GetMatrix(), camera->GetMatrixVersion());
+	else
+	{
+		glm::mat4 matrix = glm::translate(camera->GetMatrix(), glm::vec3(offset.x, offset.y, 0.0f));
+		shader->SetTransformMatrix(glm::scale(matrix, glm::vec3(scale.x, scale.y, 1.0f)));
+	}
+	shader->SetTextureUniform(*texture);
+
+	indexBuffer->Bind();
+	glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, nullptr);
+	indexBuffer->Unbind();
+	vertexBuffer->Unbind();
 
-	vertexBatch.clear();
 	renderedVertexes += vertexCount;
 	renderCalls++;
 
 	LUNA_CHECK_GL_ERROR();
 }
 
+// Get shared index buffer with indexes for at least given count of quads
+// Used for rendering quads from own vertex buffers by "RenderBuffers"
+LUNABufferObject* LUNARenderer::GetQuadIndexBuffer(size_t quadsCount)
+{
+	MakeQuadIndexes(quadsCount);
+
+	quadIndexBuffer->Bind();
+	UploadQuadIndexes();
+	quadIndexBuffer->Unbind();
+
+	return quadIndexBuffer.get();
+}
+
+// Add line to line batch
+// Consecutive lines are rendered in one call. Geometry added after lines renders them first, so lines keep order
+void LUNARenderer::RenderLine(float x1, float y1, float x2, float y2, const LUNAColor& color)
+{
+	if(lineBatch.size() + 2 > RENDER_MAX_BATCH_VERTEXES) Render(LUNAFlushReason::BATCH_FULL);
+
+	// Texture coords are unused
+	lineBatch.emplace_back(x1, y1, 0.0f, 0.0f, color);
+	lineBatch.emplace_back(x2, y2, 0.0f, 0.0f, color);
+	PremultiplyVertexes(&lineBatch[lineBatch.size() - 2], 2, LUNABlendingMode::ALPHA);
+}
+
+// Add line to debug line batch. Used for wireframes and physics debug draw
+// Debug lines are rendered over other geometry when batch is flushed, so they don't break batching
+void LUNARenderer::RenderDebugLine(float x1, float y1, float x2, float y2, const LUNAColor& color)
+{
+	if(debugLineBatch.size() + 2 > RENDER_MAX_BATCH_VERTEXES) Render(LUNAFlushReason::BATCH_FULL);
+
+	// Texture coords are unused
+	debugLineBatch.emplace_back(x1, y1, 0.0f, 0.0f, color);
+	debugLineBatch.emplace_back(x2, y2, 0.0f, 0.0f, color);
+	PremultiplyVertexes(&debugLineBatch[debugLineBatch.size() - 2], 2, LUNABlendingMode::ALPHA);
+}
+
 void LUNARenderer::BeginRender()
 {
 	inProgress = true;
+	frameIndex++;
 	renderCalls = 0;
 	renderedVertexes = 0;
+	savedRenderCalls = 0;
+	culledObjects = 0;
+	renderStats.Clear();
 
-	vertexBatch.clear();
+	ResetBatch();
+	renderQueue.Clear();
+	lineBatch.clear();
+	debugLineBatch.clear();
+
+	// Platform code can change GL state between frames
+	LUNAGlState::Invalidate();
+	LUNAGlState::ResetSkippedCalls();
 
-	glDisable(GL_DEPTH_TEST); // Depth test not needed for 2D
+	// Depth test is used only by opaque pass
+	depthPass = LUNADepthPass::NONE;
+	depthCommands = 0;
+	glDisable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
 
 	glClearColor(backColor.r, backColor.g, backColor.b, backColor.a);
 	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 }
 
-void LUNARenderer::Render()
+void LUNARenderer::Render(LUNAFlushReason reason)
+{
+	FlushRenderQueue();
+	RenderBatch(reason);
+	SetDepthPass(LUNADepthPass::NONE);
+	RenderLineBatch(lineBatch);
+	RenderLineBatch(debugLineBatch);
+}
+
+// Render lines from given line batch
+void LUNARenderer::RenderLineBatch(std::vector<LUNAVertex>& batch)
 {
-	if(vertexBatch.empty()) return;
+	if(batch.empty()) return;
 
-	int vertexCount = vertexBatch.size() / RENDER_ELEMENT_PER_VERTEX;
+	int vertexCount = batch.size();
+
+	primitivesShader->Bind();
+	const LUNAVertex* vertexes = BindVertexBatch(batch);
+	primitivesShader->SetPositionAttribute(vertexes);
+	primitivesShader->SetColorAttribute(vertexes);
+	primitivesShader->SetTransformMatrix(camera->GetMatrix(), camera->GetMatrixVersion());
+	glDrawArrays(GL_LINES, 0, vertexCount);
+	UnbindVertexBatch();
+
+	batch.clear();
+	renderedVertexes += vertexCount;
+	renderCalls++;
 
-	// Set blending mode
-	switch(curMaterial->blending)
+	LUNA_CHECK_GL_ERROR();
+}
+
+// Render batched lines before geometry added after them
+// Geometry batched before lines is rendered first
+void LUNARenderer::FlushLines()
+{
+	if(!lineBatch.empty()) Render(LUNAFlushReason::LINE);
+}
+
+// Render current batch
+void LUNARenderer::RenderBatch(LUNAFlushReason reason)
+{
+	if(vertexBatch.empty())
 	{
-	case LUNABlendingMode::NONE:
-		glDisable(GL_BLEND);
-		break;
-	case LUNABlendingMode::ALPHA:
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		break;
-	case LUNABlendingMode::ADDITIVE:
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		break;
+		ResetBatch();
+		return;
+	}
+
+	int vertexCount = vertexBatch.size();
+
+	// All materials in batch have same shader and blending mode
+	auto material = materialRegistry.Get(slotMaterials[0]);
+	auto shader = material ? material->shader.lock() : nullptr;
+
+	// Batch with several textures uses multi-texture variant of default shader
+	bool useSlots = slotMaterials.size() > 1;
+	if(useSlots) shader = multiTextureShader;
+
+	// Depth is written only by variants of default shaders used in opaque pass
+	bool useDepth = depthPass != LUNADepthPass::NONE;
+	if(useDepth && shader) shader = GetDepthShader(shader);
+
+	std::vector<std::shared_ptr<LUNATexture>> textures;
+	for(uint32_t slotMaterial : slotMaterials)
+	{
+		auto slotEntry = materialRegistry.Get(slotMaterial);
+		auto texture = slotEntry ? slotEntry->texture.lock() : nullptr;
+		if(texture) textures.push_back(texture);
+	}
+
+	// Material was deleted after adding geometry to batch
+	if(!shader || textures.size() != slotMaterials.size())
+	{
+		LUNA_LOGE("Attempt to render batch with invalid material");
+		ResetBatch();
+		return;
 	}
 
-	auto shader = curMaterial->shader.lock();
-	auto texture = curMaterial->texture.lock();
+	SetBlendingMode(material->blending);
 
 	shader->Bind();
-	shader->SetPositionAttribute(vertexBatch);
-	shader->SetColorAttribute(vertexBatch);
-	shader->SetTexCoordsAttribute(vertexBatch);
-	shader->SetTransformMatrix(camera->GetMatrix());
-	shader->SetTextureUniform(*texture);
+	const LUNAVertex* vertexes = BindVertexBatch(vertexBatch);
+	shader->SetPositionAttribute(vertexes);
+	shader->SetColorAttribute(vertexes);
+	shader->SetTexCoordsAttribute(vertexes);
+	shader->SetTransformMatrix(camera->GetMatrix(), camera->GetMatrixVersion());
 
-	glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+	// Slots and depth are read from own stream, so other batches keep smaller vertexes
+	if(useSlots || useDepth)
+	{
+		const LUNAVertexExtra* extras = BindExtraBatch();
+		if(useSlots) shader->SetTexSlotAttribute(extras);
+		if(useDepth) shader->SetDepthAttribute(extras);
+	}
 
-	vertexBatch.clear();
+	if(useSlots) shader->SetTextureSlotsUniform(textures);
+	else shader->SetTextureUniform(*textures[0]);
+
+	int indexCount = 0;
+	const unsigned short* indexes = BindIndexBatch(indexCount);
+
+	glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, indexes);
+	UnbindIndexBatch();
+	UnbindVertexBatch();
+	if(useSlots) shader->UnsetTexSlotAttribute();
+	if(useDepth) shader->UnsetDepthAttribute();
+
+	ResetBatch();
 	renderedVertexes += vertexCount;
 	renderCalls++;
+	renderStats.AddFlush(reason, vertexCount);
 
 	LUNA_CHECK_GL_ERROR();
 }
 
+void LUNARenderer::SetBlendingMode(LUNABlendingMode blending)
+{
+	switch(blending)
+	{
+	case LUNABlendingMode::NONE:
+		LUNAGlState::DisableBlending();
+		break;
+	case LUNABlendingMode::ALPHA:
+		if(premultipliedAlpha) LUNAGlState::EnableBlending(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		// Frame buffer content should have premultiplied colors and correct alpha
+		// to be composited with "premultiplied" blending mode
+		else if(frameBuffer) LUNAGlState::EnableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		else LUNAGlState::EnableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		break;
+	case LUNABlendingMode::ADDITIVE:
+		// Additive vertexes have zero alpha in premultiplied mode, so same function is used
+		if(premultipliedAlpha) LUNAGlState::EnableBlending(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		else if(frameBuffer) LUNAGlState::EnableBlending(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE);
+		else LUNAGlState::EnableBlending(GL_SRC_ALPHA, GL_ONE);
+		break;
+	case LUNABlendingMode::PREMULTIPLIED:
+		LUNAGlState::EnableBlending(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		break;
+	}
+}
+
+// Clear batch geometry and materials
+void LUNARenderer::ResetBatch()
+{
+	vertexBatch.clear();
+	indexBatch.clear();
+	extraBatch.clear();
+	slotMaterials.clear();
+	curMaterial = 0;
+	curSlot = 0;
+}
+
 void LUNARenderer::EndRender()
 {
-	Render();
+	Render(LUNAFlushReason::END_FRAME);
 
-	curMaterial = nullptr;
 	inProgress = false;
 }
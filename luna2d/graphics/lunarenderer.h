@@ -27,7 +27,14 @@
 #include "lunashader.h"
 #include "lunacamera.h"
 #include "lunamaterial.h"
+#include "lunamaterialregistry.h"
 #include "lunaframebuffer.h"
+#include "lunabufferobject.h"
+#include "lunavertex.h"
+#include "lunarenderqueue.h"
+#include "lunarenderstats.h"
+#include "lunaglstate.h"
+#include "lunaworkerpool.h"
 
 // Default shaders
 #include "shaders/default.vert.h"
@@ -36,14 +43,29 @@
 #include "shaders/primitives.frag.h"
 #include "shaders/font.vert.h"
 #include "shaders/font.frag.h"
+#include "shaders/multitexture.vert.h"
+#include "shaders/multitexture.frag.h"
 
-const int RENDER_RESERVE_BATCH = 1000; // Count of polygons for which allocated memory when renderer initializing
-const int RENDER_ELEMENT_PER_VERTEX = 8; // Count of array elements for each vertex
+const int RENDER_RESERVE_BATCH = 1000; // Count of vertexes for which allocated memory when renderer initializing
+const int RENDER_MAX_BATCH_VERTEXES = 65536; // Max count of vertexes in one batch. Limited by 16-bit indexes
+const int RENDER_VERTEX_BUFFERS_COUNT = 3; // Count of vertex buffers in ring. Each render call uses next buffer in ring
+const int RENDER_TEXTURE_SLOTS = 4; // Max count of textures in one batch when multi-texture batching is enabled. Half of 8 units guaranteed by GLES 2.0, keeps sampler selection in shader short
+const int RENDER_MAX_DEPTH = 65534; // Depth of first command in frame when opaque pass is enabled. Each next command is nearer
 
 namespace luna2d{
 
+static_assert(RENDER_TEXTURE_SLOTS <= GL_STATE_TEXTURE_UNITS, "Texture slots should fit into guaranteed texture units");
+
 class LUNAImage;
 
+// Depth test state of current batch
+enum class LUNADepthPass
+{
+	NONE, // Depth test is disabled
+	OPAQUE, // Depth test and depth writing are enabled
+	BLENDED // Depth test is enabled, depth writing is disabled
+};
+
 class LUNARenderer
 {
 public:
@@ -51,10 +73,43 @@ public:
 
 private:
 	// Vertex array for batching
-	std::vector<float> vertexBatch;
+	std::vector<LUNAVertex> vertexBatch;
+
+	// Index array for batching
+	// It's empty while batch contains only quads, in this case shared quad indexes are used
+	std::vector<unsigned short> indexBatch;
+
+	// Extra attributes of batch vertexes. It's empty while no vertex in batch needs extra attributes
+	std::vector<LUNAVertexExtra> extraBatch;
+
+	// Vertex array for batching consecutive lines. Lines are rendered in one call before next geometry
+	std::vector<LUNAVertex> lineBatch;
+
+	// Vertex array for batching debug lines. Debug lines are rendered over other geometry when batch is flushed
+	std::vector<LUNAVertex> debugLineBatch;
+
+	// Ring of vertex and index buffers for streaming batched geometry to GPU
+	std::vector<std::unique_ptr<LUNABufferObject>> vertexBuffers, indexBuffers, extraBuffers;
+	int curVertexBuffer = 0;
+	int curIndexBuffer = 0;
+	int curExtraBuffer = 0;
+
+	// Static indexes shared by all quads. Grows lazily by count of quads in batch
+	std::vector<unsigned short> quadIndexes;
+	std::unique_ptr<LUNABufferObject> quadIndexBuffer;
+	size_t uploadedQuadIndexes = 0; // Count of quad indexes uploaded to buffer
+
+	// Incremented when buffers are recreated after losing OpenGL context
+	// Objects with own buffers should upload their data again when version is changed
+	int contextVersion = 0;
 
 	// Default shader
-	std::shared_ptr<LUNAShader> defaultShader, primitivesShader, fontShader;
+	std::shared_ptr<LUNAShader> defaultShader, primitivesShader, fontShader, multiTextureShader;
+	std::unordered_map<int, std::shared_ptr<LUNAShader>> sdfFontShaders; // Keyed by edge threshold in 0-255 range
+
+	// Variants of default shaders writing depth. Made on first use by opaque pass
+	std::shared_ptr<LUNAShader> defaultDepthShader, fontDepthShader, multiTextureDepthShader;
+	std::unordered_map<int, std::shared_ptr<LUNAShader>> sdfFontDepthShaders;
 
 	// Background color
 	LUNAColor backColor = LUNAColor::WHITE;
@@ -62,32 +117,173 @@ private:
 	// Camera for current render call
 	std::shared_ptr<LUNACamera> camera;
 
-	// Material for current render call
-	const LUNAMaterial* curMaterial = nullptr;
+	// Interned materials. Materials are referenced by handles
+	LUNAMaterialRegistry materialRegistry;
+
+	// Material handle for current render call
+	uint32_t curMaterial = 0;
+
+	// Materials which textures are bound to texture slots of current batch
+	// Batch contains several slots only when multi-texture batching is enabled
+	std::vector<uint32_t> slotMaterials;
+	unsigned char curSlot = 0;
 
 	// Frame buffer
 	std::shared_ptr<LUNAFrameBuffer> frameBuffer;
 
+	// Deferred draw commands. Used only when render sorting is enabled
+	LUNARenderQueue renderQueue;
+	int renderLayer = 0;
+
 	// Info for stats
 	int renderCalls = 0; // Count of render calls on current frame
 	int renderedVertexes = 0; // Count of rendered vertexes on current frame
+	int savedRenderCalls = 0; // Count of render calls saved by render sorting on current frame
+	int culledObjects = 0; // Count of objects skipped on current frame because they are outside of camera view
+	LUNARenderStats renderStats; // Reasons and sizes of batch flushes on current frame
 
+	// Depth state for opaque pass
+	LUNADepthPass depthPass = LUNADepthPass::NONE;
+	int depthCommands = 0; // Count of commands got depth on current frame
+	unsigned short batchDepth = 0; // Depth of vertexes added to batch. 0 means depth isn't used
+
+	// Worker threads for building vertexes of large native containers
+	LUNAWorkerPool workerPool;
+
+	unsigned int frameIndex = 0; // Incremented on begin of every frame
 	bool inProgress = false;
 	bool debugRender = false;
+	bool useVertexBuffers = true;
+	bool sortRender = false;
+	bool culling = true;
+	bool multiTexture = false;
+	bool parallelBuild = true;
+	bool opaquePass = false;
+	bool hasDepthBuffer = false;
+	bool premultipliedAlpha = false; // Set by config. Can't be changed at runtime, because textures are premultiplied at load
 
 private:
-	void SetVertex(float u, float v, float x, float y, const LUNAColor& color);
+	// Make source of distance field font shader with given edge threshold in 0-255 range
+	std::string MakeSdfFontSource(int threshold);
+
+	// Make source of vertex shader variant writing depth from "a_depth" attribute
+	std::string MakeDepthSource(const std::string& vertexSource);
+
+	// Get variant of given default shader writing depth. Custom shaders are returned as is
+	std::shared_ptr<LUNAShader> GetDepthShader(const std::shared_ptr<LUNAShader>& shader);
+
+	// Upload given vertexes to next buffer in ring and bind it
+	// Returns pointer to vertex data for setting attributes. It's nullptr when vertex buffers are used
+	const LUNAVertex* BindVertexBatch(const std::vector<LUNAVertex>& batch);
+	void UnbindVertexBatch();
+
+	// Upload extra attributes of batch to next buffer in ring and bind it
+	// Returns pointer to attribute data. It's nullptr when vertex buffers are used
+	const LUNAVertexExtra* BindExtraBatch();
+
+	// Bind indexes for vertex batch. If batch contains only quads, shared quad indexes are used
+	// Returns pointer to index data for draw call. It's nullptr when index buffers are used
+	const unsigned short* BindIndexBatch(int& indexCount);
+	void UnbindIndexBatch();
+
+	// Add indexes for quad with given first vertex to index batch
+	void AddQuadIndexes(size_t firstVertex);
+
+	// Make shared quad indexes for at least given count of quads
+	void MakeQuadIndexes(size_t quadsCount);
+
+	// Upload shared quad indexes to bound quad index buffer if they were grown
+	void UploadQuadIndexes();
+
+	// Use given material for next geometry in batch. Renders batch if material can't be added to it
+	// Returns texture slot of material in batch
+	unsigned char UseMaterial(uint32_t material);
+
+	// Get reason of flush when material of batch is changed to given material
+	LUNAFlushReason GetFlushReason(uint32_t material);
+
+	// Try to add texture of given material to slots of current batch
+	bool AddTextureSlot(uint32_t material);
+
+	// Check for geometry with given blending modes can be rendered in one batch
+	// With premultiplied alpha additive blending is expressed per vertex, so it shares batch with alpha blending
+	bool IsCompatibleBlending(LUNABlendingMode blending1, LUNABlendingMode blending2);
+
+	// Set extra attributes and premultiply colors of vertexes added to batch starting from given vertex
+	void PrepareBatchVertexes(size_t firstVertex, unsigned char slot, uint32_t material);
+
+	// Add quads to batch. Each quad is 4 consecutive vertexes
+	void BatchQuads(const LUNAVertex* quads, size_t quadsCount, uint32_t material);
+
+	// Add triangles to batch. Indexes are relative to first given vertex
+	void BatchVertexes(const LUNAVertex* vertexes, size_t vertexCount,
+		const unsigned short* indexes, size_t indexCount, uint32_t material);
+
+	// Sort deferred draw commands and add them to batch
+	void FlushRenderQueue();
+
+	// Add deferred command with given index to batch
+	void BatchCommand(int index);
+
+	// Opaque pass is used only for default framebuffer, because framebuffer objects have no depth attachment
+	bool IsOpaquePassActive();
+
+	// Check for geometry with given material can be rendered with depth
+	bool HasDepth(uint32_t material);
+
+	// Render deferred commands in opaque and blended passes
+	void FlushDepthPasses();
+
+	// Render commands in given range of order. Opaque commands are rendered front to back, then blended back to front
+	void RenderDepthSegment(size_t first, size_t last);
+
+	// Switch depth state. Renders current batch if state is changed
+	void SetDepthPass(LUNADepthPass pass);
+
+	// Render current batch
+	void RenderBatch(LUNAFlushReason reason);
+
+	// Render lines from given line batch
+	void RenderLineBatch(std::vector<LUNAVertex>& batch);
+
+	// Render batched lines before geometry added after them
+	void FlushLines();
+
+	void SetBlendingMode(LUNABlendingMode blending);
+
+	// Clear batch geometry and materials
+	void ResetBatch();
 
 public:
 	bool IsInProgress();
+	unsigned int GetFrameIndex(); // Get index of current frame
 
 	int GetRenderCalls();
 	int GetRenderedVertexes();
+	int GetSavedRenderCalls();
+	int GetCulledObjects();
+	const LUNARenderStats& GetRenderStats();
 
 	std::shared_ptr<LUNAShader> GetDefaultShader();
 	std::shared_ptr<LUNAShader> GetPrimitvesShader();
 	std::shared_ptr<LUNAShader> GetFontShader();
 
+	// Get shader for distance field fonts with given edge threshold. Fonts with same threshold share shader
+	std::shared_ptr<LUNAShader> GetSdfFontShader(float threshold);
+
+	LUNAMaterialRegistry* GetMaterialRegistry();
+
+	int GetContextVersion();
+
+	// Premultiplied alpha mode is enabled by "premultipliedAlpha" field of config
+	// In this mode textures are premultiplied at load, vertex colors are premultiplied when added to batch
+	// and alpha and additive blending are both rendered with "GL_ONE, GL_ONE_MINUS_SRC_ALPHA"
+	bool IsPremultipliedAlpha();
+
+	// Premultiply colors of given vertexes when premultiplied alpha mode is enabled
+	// Additive vertexes get zero alpha, so they add color without covering background
+	void PremultiplyVertexes(LUNAVertex* vertexes, size_t count, LUNABlendingMode blending);
+
 	LUNAColor GetBackgroundColor();
 	void SetBackgroundColor(const LUNAColor& backColor);
 
@@ -96,31 +292,102 @@ public:
 	void EnableScissor(float x, float y, float width, float height);
 	void DisableScissor();
 
+	std::shared_ptr<LUNAFrameBuffer> GetFrameBuffer();
 	void SetFrameBuffer(const std::shared_ptr<LUNAFrameBuffer>& frameBuffer);
 
 	void SetDefaultViewport();
 
 	// Read screen pixels into instance of "LUNAImage"
-	std::shared_ptr<LUNAImage> ReadPixels();
+	std::shared_ptr<LUNAImage> ReadPixels(bool flip = true);
 
 	bool IsEnabledDebugRender();
 	void EnableDebugRender(bool enable);
 
+	// Enable/disable streaming batches through vertex buffer objects
+	// When disabled, batches are drawn from client-side vertex arrays
+	// On null GL backend both paths cost same CPU time within noise: the batch is copied once either way,
+	// by "glBufferData" or by driver at draw call. Buffers are kept as default for drivers which
+	// can skip per-draw copy and for objects with own static buffers. Compare with "lunarenderbench bench"
+	bool IsEnabledVertexBuffers();
+	void EnableVertexBuffers(bool enable);
+
+	// Enable/disable render sorting. When enabled, quads and vertex arrays are deferred
+	// and reordered on flush to merge batches with same material. Overlapping geometry keeps painter's order
+	bool IsEnabledRenderSorting();
+	void EnableRenderSorting(bool enable);
+
+	// Layer for sorted rendering. Commands with lower layer are rendered first
+	int GetRenderLayer();
+	void SetRenderLayer(int layer);
+
+	// Enable/disable multi-texture batching. When enabled, geometry with default shader and different textures
+	// is rendered in one batch while count of textures doesn't exceed "RENDER_TEXTURE_SLOTS"
+	bool IsEnabledMultiTexture();
+	void EnableMultiTexture(bool enable);
+
+	// Enable/disable two-pass rendering. When enabled, geometry with "none" blending mode is rendered front to back
+	// with depth writing, and blended geometry is rendered after it with depth test, so hidden pixels aren't shaded
+	// Commands are deferred like with render sorting. Requires depth buffer in default framebuffer
+	bool IsEnabledOpaquePass();
+	void EnableOpaquePass(bool enable);
+
+	// Enable/disable skipping objects outside of camera view
+	bool IsEnabledCulling();
+	void EnableCulling(bool enable);
+
+	// Check for given bounding rect is visible by camera. Should be called by objects before making vertexes
+	// Invisible objects are counted as culled
+	bool IsVisible(const LUNARect& bounds);
+
+	// Same as "IsVisible", but doesn't count culled objects. Can be called from worker threads
+	bool IsInView(const LUNARect& bounds);
+	void AddCulledObjects(int count);
+
+	// Enable/disable building vertexes of large native containers on worker threads
+	bool IsEnabledParallelBuild();
+	void EnableParallelBuild(bool enable);
+
+	// Split given count of items into ranges of "jobSize" items and run job for each range
+	// Ranges are run on worker threads when parallel build is enabled. Job should write only to own range
+	// and shouldn't call renderer methods except "IsInView". Returns when all ranges are done
+	void BuildParallel(size_t count, size_t jobSize, const LUNAWorkerJob& job);
+
 	void RenderQuad(float x1, float y1, float u1, float v1,
 		float x2, float y2, float u2, float v2,
 		float x3, float y3, float u3, float v3,
 		float x4, float y4, float u4, float v4,
 		const LUNAMaterial* material, const LUNAColor& color);
 
-	void RenderVertexArray(std::vector<float>& vertexes, const LUNAMaterial* material);
+	// Render quads from given vertexes. Each quad is 4 consecutive vertexes in same order as in "RenderQuad"
+	void RenderQuads(const LUNAVertex* quads, size_t quadsCount, const LUNAMaterial* material);
 
+	// Render triangles from given vertexes. Indexes are relative to first vertex in given array
+	void RenderVertexArray(const std::vector<LUNAVertex>& vertexes, const std::vector<unsigned short>& indexes,
+		const LUNAMaterial* material);
+
+	// Render triangles from given vertex and index buffers without batching
+	// Vertex buffer should contain vertexes in "LUNAVertex" format. Vertexes are scaled and moved by given offset in shader
+	// If color is given, it's used for all vertexes instead of their colors
+	void RenderBuffers(LUNABufferObject* vertexBuffer, LUNABufferObject* indexBuffer, int vertexCount, int indexCount,
+		const LUNAMaterial* material, const glm::vec2& offset = glm::vec2(), const glm::vec2& scale = glm::vec2(1.0f),
+		const LUNAColor* color = nullptr);
+
+	// Get shared index buffer with indexes for at least given count of quads
+	// Used for rendering quads from own vertex buffers by "RenderBuffers"
+	LUNABufferObject* GetQuadIndexBuffer(size_t quadsCount);
+
+	// Add line to line batch. Consecutive lines are rendered in one call, lines keep order with other geometry
 	void RenderLine(float x1, float y1, float x2, float y2, const LUNAColor& color);
 
+	// Add line to debug line batch. Used for wireframes and physics debug draw
+	// Debug lines are rendered over other geometry when batch is flushed, so they don't break batching
+	void RenderDebugLine(float x1, float y1, float x2, float y2, const LUNAColor& color);
+
 	void BeginRender();
-	void Render();
+	void Render(LUNAFlushReason reason);
 	void EndRender();
 
-// Reload default shaders when application lost OpenGL context
+// Reload default shaders and buffers when application lost OpenGL context
 // SEE: "lunaassets.h"
 #if LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
 public:
@@ -128,7 +395,26 @@ public:
 	{
 		defaultShader->Reload(DEFAULT_VERT_SHADER, DEFAULT_FRAG_SHADER);
 		primitivesShader->Reload(PRIMITIVES_VERT_SHADER, PRIMITIVES_FRAG_SHADER);
-		fontShader->Reload(FONT_VERT_SHADER, FONT_FRAG_SHADER);
+		fontShader->Reload(FONT_VERT_SHADER, premultipliedAlpha ? FONT_PREMULTIPLIED_FRAG_SHADER : FONT_FRAG_SHADER);
+		multiTextureShader->Reload(MULTITEXTURE_VERT_SHADER, MULTITEXTURE_FRAG_SHADER);
+		for(auto& entry : sdfFontShaders) entry.second->Reload(FONT_VERT_SHADER, MakeSdfFontSource(entry.first));
+
+		if(defaultDepthShader) defaultDepthShader->Reload(MakeDepthSource(DEFAULT_VERT_SHADER), DEFAULT_FRAG_SHADER);
+		if(fontDepthShader) fontDepthShader->Reload(MakeDepthSource(FONT_VERT_SHADER),
+			premultipliedAlpha ? FONT_PREMULTIPLIED_FRAG_SHADER : FONT_FRAG_SHADER);
+		if(multiTextureDepthShader) multiTextureDepthShader->Reload(MakeDepthSource(MULTITEXTURE_VERT_SHADER), MULTITEXTURE_FRAG_SHADER);
+		for(auto& entry : sdfFontDepthShaders) entry.second->Reload(MakeDepthSource(FONT_VERT_SHADER), MakeSdfFontSource(entry.first));
+	}
+
+	inline void ReloadBuffers()
+	{
+		LUNAGlState::Invalidate();
+		for(auto& buffer : vertexBuffers) buffer->Reload();
+		for(auto& buffer : indexBuffers) buffer->Reload();
+		for(auto& buffer : extraBuffers) buffer->Reload();
+		quadIndexBuffer->Reload();
+		uploadedQuadIndexes = 0;
+		contextVersion++;
 	}
 #endif
 };
@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunarenderqueue.h"
+#include <numeric>
+
+using namespace luna2d;
+
+// Get layer from sort key
+static inline int GetKeyLayer(uint64_t sortKey)
+{
+	return (int)(sortKey >> 48);
+}
+
+LUNARenderQueue::LUNARenderQueue(const LUNAMaterialRegistry* materialRegistry) :
+	materialRegistry(materialRegistry)
+{
+}
+
+// Make sort key from layer, shader, texture and blending mode of material
+// Key layout (from high to low bits): layer(16), shader(16), texture(24), blending(8)
+uint64_t LUNARenderQueue::MakeSortKey(uint32_t material, int layer)
+{
+	auto entry = materialRegistry->Get(material);
+
+	uint64_t layerBits = (uint64_t)(std::min(std::max(layer + 32768, 0), 0xFFFF));
+	uint64_t materialBits = entry ? entry->sortBits : 0;
+
+	return (layerBits << 48) | materialBits;
+}
+
+void LUNARenderQueue::AddCommand(uint32_t material, int layer, size_t vertexCount, size_t indexCount)
+{
+	if(commands.empty() || material != lastMaterial || layer != lastLayer)
+	{
+		lastMaterial = material;
+		lastLayer = layer;
+		lastSortKey = MakeSortKey(material, layer);
+	}
+
+	Command command;
+	command.sortKey = lastSortKey;
+	command.material = material;
+	command.firstVertex = vertexes.size() - vertexCount;
+	command.vertexCount = vertexCount;
+	command.firstIndex = indexes.size() - indexCount;
+	command.indexCount = indexCount;
+
+	command.minX = command.maxX = vertexes[command.firstVertex].x;
+	command.minY = command.maxY = vertexes[command.firstVertex].y;
+	for(size_t i = command.firstVertex + 1; i < vertexes.size(); i++)
+	{
+		const LUNAVertex& vertex = vertexes[i];
+		command.minX = std::min(command.minX, vertex.x);
+		command.minY = std::min(command.minY, vertex.y);
+		command.maxX = std::max(command.maxX, vertex.x);
+		command.maxY = std::max(command.maxY, vertex.y);
+	}
+
+	commands.push_back(command);
+}
+
+// Check for overlapping bounding boxes of batch and command
+// Boxes which only touch each other aren't overlapped
+bool LUNARenderQueue::IsOverlapping(const Batch& batch, const Command& command)
+{
+	return batch.minX < command.maxX && command.minX < batch.maxX &&
+		batch.minY < command.maxY && command.minY < batch.maxY;
+}
+
+bool LUNARenderQueue::IsEmpty()
+{
+	return commands.empty();
+}
+
+const LUNARenderQueue::Command& LUNARenderQueue::GetCommand(int index)
+{
+	return commands[index];
+}
+
+const LUNAVertex* LUNARenderQueue::GetVertexes(const Command& command)
+{
+	return &vertexes[command.firstVertex];
+}
+
+const unsigned short* LUNARenderQueue::GetIndexes(const Command& command)
+{
+	return command.indexCount > 0 ? &indexes[command.firstIndex] : nullptr;
+}
+
+// Add quad from 4 given vertexes
+void LUNARenderQueue::AddQuad(const LUNAVertex* quad, uint32_t material, int layer)
+{
+	vertexes.insert(vertexes.end(), quad, quad + 4);
+	AddCommand(material, layer, 4, 0);
+}
+
+// Add triangles from given vertexes. Indexes are relative to first vertex in given array
+void LUNARenderQueue::AddVertexArray(const std::vector<LUNAVertex>& vertexes, const std::vector<unsigned short>& indexes,
+	uint32_t material, int layer)
+{
+	if(vertexes.empty() || indexes.empty()) return;
+
+	this->vertexes.insert(this->vertexes.end(), vertexes.begin(), vertexes.end());
+	this->indexes.insert(this->indexes.end(), indexes.begin(), indexes.end());
+	AddCommand(material, layer, vertexes.size(), indexes.size());
+}
+
+// Reorder commands to merge them into as few batches as possible
+// Returns count of render calls saved by reordering
+int LUNARenderQueue::Sort()
+{
+	order.clear();
+	batches.clear();
+	if(commands.empty()) return 0;
+
+	int count = commands.size();
+
+	// Count of batches when commands rendered in submission order
+	int unsortedBatches = 1;
+	for(int i = 1; i < count; i++)
+	{
+		if(commands[i].sortKey != commands[i - 1].sortKey) unsortedBatches++;
+	}
+
+	// Commands with lower layer always rendered before commands with higher layer
+	// Inside one layer submission order is kept
+	order.resize(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b)
+	{
+		return GetKeyLayer(commands[a].sortKey) < GetKeyLayer(commands[b].sortKey);
+	});
+
+	// Move each command back to latest batch with same key,
+	// if command doesn't overlap any batch rendered after that batch
+	nextCommand.assign(count, -1);
+	for(int index : order)
+	{
+		const Command& command = commands[index];
+		int target = -1;
+		int last = batches.size() - 1;
+
+		for(int i = last; i >= 0 && i > last - RENDER_QUEUE_MERGE_WINDOW; i--)
+		{
+			if(batches[i].sortKey == command.sortKey)
+			{
+				target = i;
+				break;
+			}
+
+			if(IsOverlapping(batches[i], command)) break;
+		}
+
+		if(target == -1)
+		{
+			batches.push_back({ command.sortKey, index, index, command.minX, command.minY, command.maxX, command.maxY });
+			continue;
+		}
+
+		Batch& batch = batches[target];
+		nextCommand[batch.lastCommand] = index;
+		batch.lastCommand = index;
+		batch.minX = std::min(batch.minX, command.minX);
+		batch.minY = std::min(batch.minY, command.minY);
+		batch.maxX = std::max(batch.maxX, command.maxX);
+		batch.maxY = std::max(batch.maxY, command.maxY);
+	}
+
+	order.clear();
+	for(const auto& batch : batches)
+	{
+		for(int i = batch.firstCommand; i != -1; i = nextCommand[i]) order.push_back(i);
+	}
+
+	return std::max(unsortedBatches - (int)batches.size(), 0);
+}
+
+// Use submission order of commands instead of sorting
+void LUNARenderQueue::KeepOrder()
+{
+	order.resize(commands.size());
+	std::iota(order.begin(), order.end(), 0);
+}
+
+// Get order of commands after sorting
+const std::vector<int>& LUNARenderQueue::GetOrder()
+{
+	return order;
+}
+
+void LUNARenderQueue::Clear()
+{
+	commands.clear();
+	vertexes.clear();
+	indexes.clear();
+	batches.clear();
+	order.clear();
+}
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunamaterialregistry.h"
+#include "lunavertex.h"
+
+namespace luna2d{
+
+const int RENDER_QUEUE_MERGE_WINDOW = 32; // Count of last batches checked when merging command into existing batch
+
+//-----------------------------------------------------------------
+// Deferred list of draw commands
+// Commands are sorted by key (layer, shader, texture, blending)
+// and merged into batches, but painter's order of overlapping
+// commands is kept
+//-----------------------------------------------------------------
+class LUNARenderQueue
+{
+public:
+	LUNARenderQueue(const LUNAMaterialRegistry* materialRegistry);
+
+	struct Command
+	{
+		uint64_t sortKey;
+		uint32_t material; // Material handle
+		size_t firstVertex, vertexCount;
+		size_t firstIndex, indexCount; // For quads "indexCount" is 0
+		float minX, minY, maxX, maxY; // Bounding box of command geometry
+	};
+
+private:
+	const LUNAMaterialRegistry* materialRegistry;
+
+	std::vector<Command> commands;
+	std::vector<LUNAVertex> vertexes;
+	std::vector<unsigned short> indexes;
+
+	// Sort key of last added command. Consecutive commands usually have same material
+	uint32_t lastMaterial = 0;
+	int lastLayer = 0;
+	uint64_t lastSortKey = 0;
+
+	// Batch of commands with same sort key. Commands in batch are linked by "nextCommand"
+	struct Batch
+	{
+		uint64_t sortKey;
+		int firstCommand, lastCommand;
+		float minX, minY, maxX, maxY; // Bounding box of all commands in batch
+	};
+
+	std::vector<Batch> batches;
+	std::vector<int> nextCommand;
+
+	// Order of commands after sorting
+	std::vector<int> order;
+
+private:
+	// Make sort key from layer, shader, texture and blending mode of material
+	uint64_t MakeSortKey(uint32_t material, int layer);
+
+	void AddCommand(uint32_t material, int layer, size_t vertexCount, size_t indexCount);
+
+	// Check for overlapping bounding boxes of batch and command
+	bool IsOverlapping(const Batch& batch, const Command& command);
+
+public:
+	bool IsEmpty();
+
+	const Command& GetCommand(int index);
+	const LUNAVertex* GetVertexes(const Command& command);
+	const unsigned short* GetIndexes(const Command& command);
+
+	// Add quad from 4 given vertexes
+	void AddQuad(const LUNAVertex* quad, uint32_t material, int layer);
+
+	// Add triangles from given vertexes. Indexes are relative to first vertex in given array
+	void AddVertexArray(const std::vector<LUNAVertex>& vertexes, const std::vector<unsigned short>& indexes,
+		uint32_t material, int layer);
+
+	// Reorder commands to merge them into as few batches as possible
+	// Returns count of render calls saved by reordering
+	int Sort();
+
+	// Use submission order of commands instead of sorting
+	void KeepOrder();
+
+	// Get order of commands after sorting
+	const std::vector<int>& GetOrder();
+
+	void Clear();
+};
+
+}
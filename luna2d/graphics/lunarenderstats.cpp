@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunarenderstats.h"
+
+using namespace luna2d;
+
+// Get count of flushes with given reason
+int LUNARenderStats::GetFlushes(LUNAFlushReason reason) const
+{
+	return flushes[static_cast<int>(reason)];
+}
+
+const std::vector<LUNAFlushReason>& LUNARenderStats::GetBatchReasons() const
+{
+	return batchReasons;
+}
+
+const std::vector<int>& LUNARenderStats::GetBatchSizes() const
+{
+	return batchSizes;
+}
+
+void LUNARenderStats::AddFlush(LUNAFlushReason reason, int batchSize)
+{
+	flushes[static_cast<int>(reason)]++;
+	batchReasons.push_back(reason);
+	batchSizes.push_back(batchSize);
+}
+
+void LUNARenderStats::Clear()
+{
+	std::fill(flushes, flushes + FLUSH_REASONS_COUNT, 0);
+	batchReasons.clear();
+	batchSizes.clear();
+}
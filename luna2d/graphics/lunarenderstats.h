@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunastringenum.h"
+#include <vector>
+
+namespace luna2d{
+
+// Reason of rendering current batch
+enum class LUNAFlushReason
+{
+	TEXTURE, // Texture of material was changed
+	SHADER, // Shader of material was changed
+	BLENDING, // Blending mode of material was changed
+	BATCH_FULL, // Batch reached max count of vertexes
+	SCISSOR, // Scissor test was enabled or disabled
+	CAMERA, // Camera was changed during render
+	LINE, // Geometry was rendered after line, so batched lines should be rendered before it
+	FRAME_BUFFER, // Frame buffer was switched
+	STATIC_MESH, // Static mesh was rendered from own buffers
+	SETTINGS, // Renderer settings were changed during render
+	DEPTH_PASS, // Opaque pass was switched to blended pass or back
+	END_FRAME // Frame was ended
+};
+
+const LUNAStringEnum<LUNAFlushReason> FLUSH_REASON =
+{
+	"texture",
+	"shader",
+	"blending",
+	"batchFull",
+	"scissor",
+	"camera",
+	"line",
+	"frameBuffer",
+	"staticMesh",
+	"settings",
+	"depthPass",
+	"endFrame"
+};
+
+const int FLUSH_REASONS_COUNT = 12;
+
+//------------------------------------------
+// Stats of batch flushes on rendered frame
+//------------------------------------------
+class LUNARenderStats
+{
+private:
+	int flushes[FLUSH_REASONS_COUNT] = {};
+	std::vector<LUNAFlushReason> batchReasons; // Reason of each flush in order of flushes
+	std::vector<int> batchSizes; // Count of vertexes in each flushed batch
+
+public:
+	// Get count of flushes with given reason
+	int GetFlushes(LUNAFlushReason reason) const;
+
+	const std::vector<LUNAFlushReason>& GetBatchReasons() const;
+	const std::vector<int>& GetBatchSizes() const;
+
+	void AddFlush(LUNAFlushReason reason, int batchSize);
+	void Clear();
+};
+
+}
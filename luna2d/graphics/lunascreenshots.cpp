@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunascreenshots.h"
+#include "lunagraphics.h"
+#include "lunajpegformat.h"
+
+using namespace luna2d;
+
+LUNAScreenshots::~LUNAScreenshots()
+{
+	if(!thread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	wakeCondition.notify_all();
+	thread.join();
+}
+
+void LUNAScreenshots::WorkerLoop()
+{
+	while(true)
+	{
+		std::unique_ptr<Task> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeCondition.wait(lock, [this]() { return stop || !pendingTasks.empty(); });
+
+			// Pending tasks are finished before stopping
+			if(pendingTasks.empty()) return;
+
+			task = std::move(pendingTasks.front());
+			pendingTasks.pop_front();
+		}
+
+		task->success = ProcessTask(*task);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		doneTasks.push_back(std::move(task));
+	}
+}
+
+// Runs on background thread. Task is owned by this thread until it's moved to done tasks
+bool LUNAScreenshots::ProcessTask(Task& task)
+{
+	task.image->FlipVertically();
+
+	std::vector<unsigned char> fileData;
+	if(!task.format->Encode(task.image->GetData(), fileData, task.image->GetWidth(), task.image->GetHeight(),
+		task.image->GetColorType())) return false;
+
+	return LUNAEngine::SharedFiles()->WriteFile(task.filename, fileData, task.location);
+}
+
+// Capture current content of screen and save it to given file
+// Should be called after frame is rendered. Format is selected by file extension
+void LUNAScreenshots::Take(const std::string& filename, const LuaFunction& fnCallback, LUNAFileLocation location)
+{
+	std::unique_ptr<Task> task(new Task());
+	task->filename = filename;
+	task->location = location;
+	task->fnCallback = fnCallback;
+
+	std::string ext = LUNAEngine::SharedFiles()->GetExtension(filename);
+	if(ext == "jpg" || ext == "jpeg") task->format = std::unique_ptr<LUNAJpegFormat>(new LUNAJpegFormat());
+	else task->format = std::unique_ptr<LUNAPngFormat>(new LUNAPngFormat());
+
+	// Reading pixels must be done on thread owning GL context
+	task->image = LUNAEngine::SharedGraphics()->GetRenderer()->ReadPixels(false);
+
+	if(!thread.joinable()) thread = std::thread(&LUNAScreenshots::WorkerLoop, this);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingTasks.push_back(std::move(task));
+	}
+
+	wakeCondition.notify_one();
+}
+
+int LUNAScreenshots::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (int)(pendingTasks.size() + doneTasks.size());
+}
+
+// Call callbacks of saved screenshots
+void LUNAScreenshots::Update()
+{
+	std::deque<std::unique_ptr<Task>> tasks;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(doneTasks.empty()) return;
+		tasks.swap(doneTasks);
+	}
+
+	for(const auto& task : tasks)
+	{
+		if(!task->success) LUNA_LOGE("Cannot save screenshot to \"%s\"", task->filename.c_str());
+		if(task->fnCallback) task->fnCallback.CallVoid(task->success, task->filename);
+	}
+}
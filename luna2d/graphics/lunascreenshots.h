@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunaimage.h"
+#include "lunafiles.h"
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace luna2d{
+
+//-------------------------------------------------------------------
+// Asynchronous screenshot capturing
+// Pixels are read from framebuffer on main thread, then flipping,
+// encoding and writing to file are done on background thread.
+// Callbacks are called on main thread from "Update"
+//-------------------------------------------------------------------
+class LUNAScreenshots
+{
+public:
+	~LUNAScreenshots();
+
+private:
+	struct Task
+	{
+		std::string filename;
+		LUNAFileLocation location;
+		std::shared_ptr<LUNAImage> image;
+		std::unique_ptr<LUNAImageFormat> format;
+		LuaFunction fnCallback;
+		bool success = false;
+	};
+
+private:
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	bool stop = false;
+
+	// Guarded by mutex
+	std::deque<std::unique_ptr<Task>> pendingTasks;
+	std::deque<std::unique_ptr<Task>> doneTasks;
+
+private:
+	void WorkerLoop();
+	static bool ProcessTask(Task& task);
+
+public:
+	// Capture current content of screen and save it to given file
+	// Should be called after frame is rendered. Format is selected by file extension
+	void Take(const std::string& filename, const LuaFunction& fnCallback,
+		LUNAFileLocation location = LUNAFileLocation::APP_FOLDER);
+
+	int GetPendingCount(); // Get count of screenshots not saved yet
+
+	// Call callbacks of saved screenshots
+	void Update();
+};
+
+}
@@ -24,6 +24,7 @@
 #include "lunashader.h"
 #include "lunaplatform.h"
 #include "lunarenderer.h"
+#include "lunaglstate.h"
 
 using namespace luna2d;
 
@@ -144,8 +145,16 @@ void LUNAShader::FetchDefaultAttributes()
 	a_position = glGetAttribLocation(program, "a_position");
 	a_color = glGetAttribLocation(program, "a_color");
 	a_texCoords = glGetAttribLocation(program, "a_texCoords");
+	a_texSlot = glGetAttribLocation(program, "a_texSlot");
+	a_depth = glGetAttribLocation(program, "a_depth");
 	u_transformMatrix = glGetUniformLocation(program, "u_transformMatrix");
 	u_texture = glGetUniformLocation(program, "u_texture");
+	u_textures = glGetUniformLocation(program, "u_textures");
+
+	// Uniforms of new program are reset
+	transformVersion = 0;
+	textureUnit = -1;
+	textureSlotsSet = false;
 }
 
 // Add default preprocessor directives to vertex shader source
@@ -160,6 +169,18 @@ std::string LUNAShader::PreprocessFragment(const std::string& source)
 	return GLES_DEFAULT_PRECISION + GLES_PRECISIONS + source;
 }
 
+// Get pointer to attribute with given offset (in bytes) from begin of vertex
+const GLvoid* LUNAShader::GetAttributePointer(const void* vertexes, size_t offset)
+{
+	// For bound vertex buffer pointer is interpreted as offset in buffer
+	return reinterpret_cast<const GLvoid*>(reinterpret_cast<uintptr_t>(vertexes) + offset);
+}
+
+GLuint LUNAShader::GetId() const
+{
+	return program;
+}
+
 bool LUNAShader::IsValid()
 {
 	return glIsProgram(program);
@@ -175,40 +196,99 @@ bool LUNAShader::HasTexture()
 	return u_texture != -1 && a_texCoords != -1;
 }
 
+bool LUNAShader::HasTextureSlots()
+{
+	return u_textures != -1 && a_texSlot != -1 && a_texCoords != -1;
+}
+
+bool LUNAShader::HasDepthAttribute()
+{
+	return a_depth != -1;
+}
+
 void LUNAShader::Bind()
 {
-	glUseProgram(program);
+	LUNAGlState::UseProgram(program);
 }
 
 void LUNAShader::Unbind()
 {
-	glUseProgram(0);
+	LUNAGlState::UseProgram(0);
+}
+
+void LUNAShader::SetPositionAttribute(const LUNAVertex* vertexes)
+{
+	LUNAGlState::EnableVertexAttribArray(a_position);
+	glVertexAttribPointer(a_position, 2, GL_FLOAT, GL_FALSE, sizeof(LUNAVertex),
+		GetAttributePointer(vertexes, offsetof(LUNAVertex, x)));
 }
 
-void LUNAShader::SetPositionAttribute(const std::vector<float>& vertexArray)
+void LUNAShader::SetColorAttribute(const LUNAVertex* vertexes)
 {
-	glEnableVertexAttribArray(a_position);
-	glVertexAttribPointer(a_position, 2, GL_FLOAT, GL_FALSE, RENDER_ELEMENT_PER_VERTEX * sizeof(float), &vertexArray[0]);
+	if(!HasColorAttribute()) return;
+
+	LUNAGlState::EnableVertexAttribArray(a_color);
+	glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(LUNAVertex),
+		GetAttributePointer(vertexes, offsetof(LUNAVertex, r)));
 }
 
-void LUNAShader::SetColorAttribute(const std::vector<float>& vertexArray)
+// Use same color for all vertexes instead of color array
+// Disabled attribute array is replaced by constant value of attribute
+void LUNAShader::SetColorConstant(float r, float g, float b, float a)
 {
 	if(!HasColorAttribute()) return;
 
-	glEnableVertexAttribArray(a_color);
-	glVertexAttribPointer(a_color, 4, GL_FLOAT, GL_FALSE, RENDER_ELEMENT_PER_VERTEX * sizeof(float), &vertexArray[0] + 2);
+	LUNAGlState::DisableVertexAttribArray(a_color);
+	glVertexAttrib4f(a_color, r, g, b, a);
 }
 
-void LUNAShader::SetTexCoordsAttribute(const std::vector<float>& vertexArray)
+void LUNAShader::SetTexCoordsAttribute(const LUNAVertex* vertexes)
 {
 	if(!HasTexture()) return;
 
-	glEnableVertexAttribArray(a_texCoords);
-	glVertexAttribPointer(a_texCoords, 2, GL_FLOAT, GL_FALSE, RENDER_ELEMENT_PER_VERTEX * sizeof(float), &vertexArray[0] + 6);
+	LUNAGlState::EnableVertexAttribArray(a_texCoords);
+	glVertexAttribPointer(a_texCoords, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(LUNAVertex),
+		GetAttributePointer(vertexes, offsetof(LUNAVertex, u)));
+}
+
+// Slots are read from separate stream of extra attributes
+void LUNAShader::SetTexSlotAttribute(const LUNAVertexExtra* extras)
+{
+	if(!HasTextureSlots()) return;
+
+	LUNAGlState::EnableVertexAttribArray(a_texSlot);
+	glVertexAttribPointer(a_texSlot, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(LUNAVertexExtra),
+		GetAttributePointer(extras, offsetof(LUNAVertexExtra, slot)));
+}
+
+// Other shaders don't use slot attribute, so it should be disabled after render call
+void LUNAShader::UnsetTexSlotAttribute()
+{
+	if(HasTextureSlots()) LUNAGlState::DisableVertexAttribArray(a_texSlot);
+}
+
+// Depth is read from separate stream of extra attributes
+void LUNAShader::SetDepthAttribute(const LUNAVertexExtra* extras)
+{
+	if(!HasDepthAttribute()) return;
+
+	LUNAGlState::EnableVertexAttribArray(a_depth);
+	glVertexAttribPointer(a_depth, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(LUNAVertexExtra),
+		GetAttributePointer(extras, offsetof(LUNAVertexExtra, depth)));
 }
 
-void LUNAShader::SetTransformMatrix(const glm::mat4& matrix)
+// Depth attribute is used only by opaque pass, so it should be disabled after render call
+void LUNAShader::UnsetDepthAttribute()
 {
+	if(HasDepthAttribute()) LUNAGlState::DisableVertexAttribArray(a_depth);
+}
+
+// Shader should be bound
+void LUNAShader::SetTransformMatrix(const glm::mat4& matrix, unsigned int version)
+{
+	if(version != 0 && transformVersion == version) return;
+
+	transformVersion = version;
 	glUniformMatrix4fv(u_transformMatrix, 1, GL_FALSE, &matrix[0][0]);
 }
 
@@ -216,7 +296,37 @@ void LUNAShader::SetTextureUniform(const LUNATexture& texture)
 {
 	if(!HasTexture()) return;
 
-	glActiveTexture(GL_TEXTURE0);
+	LUNAGlState::ActiveTexture(GL_TEXTURE0);
 	texture.Bind();
-	glUniform1i(u_texture, 0);
+
+	if(textureUnit != 0)
+	{
+		textureUnit = 0;
+		glUniform1i(u_texture, 0);
+	}
+}
+
+// Bind given textures to texture units in order of slots
+void LUNAShader::SetTextureSlotsUniform(const std::vector<std::shared_ptr<LUNATexture>>& textures)
+{
+	if(!HasTextureSlots()) return;
+
+	int count = std::min((int)textures.size(), RENDER_TEXTURE_SLOTS);
+	for(int i = 0; i < count; i++)
+	{
+		LUNAGlState::ActiveTexture(GL_TEXTURE0 + i);
+		textures[i]->Bind();
+	}
+	LUNAGlState::ActiveTexture(GL_TEXTURE0);
+
+	// Each slot always refers to unit with same number, so units are set once per program
+	// Unused slots aren't sampled by shader
+	if(!textureSlotsSet)
+	{
+		GLint units[RENDER_TEXTURE_SLOTS];
+		for(int i = 0; i < RENDER_TEXTURE_SLOTS; i++) units[i] = i;
+
+		glUniform1iv(u_textures, RENDER_TEXTURE_SLOTS, units);
+		textureSlotsSet = true;
+	}
 }
@@ -25,6 +25,7 @@
 
 #include "lunatexture.h"
 #include "lunaglm.h"
+#include "lunavertex.h"
 
 namespace luna2d{
 
@@ -45,8 +46,16 @@ private:
 	GLint a_position = -1;
 	GLint a_color = -1;
 	GLint a_texCoords = -1;
+	GLint a_texSlot = -1;
+	GLint a_depth = -1;
 	GLint u_transformMatrix = -1;
 	GLint u_texture = -1;
+	GLint u_textures = -1;
+
+	// Cached uniform values. Used to skip uploading of unchanged values
+	unsigned int transformVersion = 0; // Version of last uploaded camera matrix
+	GLint textureUnit = -1;
+	bool textureSlotsSet = false;
 
 private:
 	// Load and compile shader
@@ -64,16 +73,36 @@ private:
 	// Add default preprocessor directives to fragment shader source
 	std::string PreprocessFragment(const std::string& source);
 
+	// Get pointer to attribute with given offset (in bytes) from begin of vertex
+	const GLvoid* GetAttributePointer(const void* vertexes, size_t offset);
+
 public:
+	GLuint GetId() const;
 	bool IsValid();
 	bool HasColorAttribute();
 	bool HasTexture();
-	void SetPositionAttribute(const std::vector<float>& vertexArray);
-	void SetColorAttribute(const std::vector<float>& vertexArray);
-	void SetTexCoordsAttribute(const std::vector<float>& vertexArray);
-	void SetTransformMatrix(const glm::mat4& matrix);
+	bool HasTextureSlots();
+	bool HasDepthAttribute();
+
+	// Set pointers to vertex attributes in given vertex array
+	// When vertex buffer object is bound, "vertexes" should be nullptr
+	void SetPositionAttribute(const LUNAVertex* vertexes);
+	void SetColorAttribute(const LUNAVertex* vertexes);
+	void SetColorConstant(float r, float g, float b, float a); // Use same color for all vertexes instead of color array
+	void SetTexCoordsAttribute(const LUNAVertex* vertexes);
+	void SetTexSlotAttribute(const LUNAVertexExtra* extras); // Slots are read from separate stream of extra attributes
+	void UnsetTexSlotAttribute();
+	void SetDepthAttribute(const LUNAVertexExtra* extras); // Depth is read from separate stream of extra attributes
+	void UnsetDepthAttribute();
+
+	// Matrix is uploaded only if given version differs from version of last uploaded matrix
+	// Version 0 means matrix without version, it's always uploaded
+	void SetTransformMatrix(const glm::mat4& matrix, unsigned int version = 0);
 	void SetTextureUniform(const LUNATexture& texture);
 
+	// Bind given textures to texture units in order of slots
+	void SetTextureSlotsUniform(const std::vector<std::shared_ptr<LUNATexture>>& textures);
+
 	void Bind();
 	void Unbind();
 
@@ -36,8 +36,7 @@ LUNASprite::LUNASprite() {}
 LUNASprite::LUNASprite(const LuaAny& asset)
 {
 	// Create sprite from texture
-	material.texture = asset.To<std::weak_ptr<LUNATexture>>();
-	if(InitFromTexture(material.texture)) return;
+	if(InitFromTexture(asset.To<std::weak_ptr<LUNATexture>>())) return;
 
 	// Create sprite from texture region
 	auto region = asset.To<std::weak_ptr<LUNATextureRegion>>();
@@ -58,7 +57,7 @@ LUNASprite::LUNASprite(const std::weak_ptr<LUNATextureRegion>& region)
 
 LUNASprite::LUNASprite(const LUNASprite& spr)
 {
-	material.texture = spr.material.texture;
+	material.SetTexture(spr.material.GetTexture());
 	x = spr.x;
 	y = spr.y;
 	originX = spr.originX;
@@ -79,7 +78,7 @@ bool LUNASprite::InitFromTexture(const std::weak_ptr<LUNATexture>& texture)
 {
 	if(texture.expired()) return false;
 
-	material.texture = texture;
+	material.SetTexture(texture);
 
 	u1 = 0;
 	v1 = 0;
@@ -99,8 +98,10 @@ bool LUNASprite::InitFromRegion(const std::weak_ptr<LUNATextureRegion>& region)
 	if(region.expired()) return false;
 
 	auto sharedRegion = region.lock();
-	material.texture = sharedRegion->GetTexture();
-	if(material.texture.expired()) return false;
+	auto texture = sharedRegion->GetTexture();
+	if(texture.expired()) return false;
+
+	material.SetTexture(texture);
 
 	u1 = sharedRegion->GetU1();
 	v1 = sharedRegion->GetV1();
@@ -113,15 +114,27 @@ bool LUNASprite::InitFromRegion(const std::weak_ptr<LUNATextureRegion>& region)
 	return true;
 }
 
+// Set texture coordinates
+void LUNASprite::SetUv(float u1, float v1, float u2, float v2)
+{
+	if(this->u1 == u1 && this->v1 == v1 && this->u2 == u2 && this->v2 == v2) return;
+
+	version++;
+	this->u1 = u1;
+	this->v1 = v1;
+	this->u2 = u2;
+	this->v2 = v2;
+}
+
 void LUNASprite::SetTexture(const std::weak_ptr<LUNATexture>& texture)
 {
 	if(texture.expired()) LUNA_RETURN_ERR("Attempt set invalid texure to sprite");
 
-	material.texture = texture.lock();
-	u1 = 0;
-	v1 = 0;
-	u2 = 1;
-	v2 = 1;
+	uint32_t prevMaterial = material.GetHandle();
+	material.SetTexture(texture);
+	if(material.GetHandle() != prevMaterial) version++;
+
+	SetUv(0, 0, 1, 1);
 }
 
 void LUNASprite::SetTextureRegion(const std::weak_ptr<LUNATextureRegion>& region)
@@ -133,11 +146,11 @@ void LUNASprite::SetTextureRegion(const std::weak_ptr<LUNATextureRegion>& region
 
 		if(!regionTexture.expired())
 		{
-			material.texture = regionTexture;
-			u1 = sharedRegion->GetU1();
-			v1 = sharedRegion->GetV1();
-			u2 = sharedRegion->GetU2();
-			v2 = sharedRegion->GetV2();
+			uint32_t prevMaterial = material.GetHandle();
+			material.SetTexture(regionTexture);
+			if(material.GetHandle() != prevMaterial) version++;
+
+			SetUv(sharedRegion->GetU1(), sharedRegion->GetV1(), sharedRegion->GetU2(), sharedRegion->GetV2());
 			return;
 		}
 	}
@@ -149,17 +162,31 @@ void LUNASprite::SetShader(const std::weak_ptr<LUNAShader>& shader)
 {
 	if(shader.expired()) LUNA_RETURN_ERR("Attempt set invalid shader to sprite");
 
-	material.shader = shader;
+	uint32_t prevMaterial = material.GetHandle();
+	material.SetShader(shader);
+	if(material.GetHandle() != prevMaterial) version++;
+}
+
+const LUNAMaterial* LUNASprite::GetMaterial()
+{
+	return &material;
+}
+
+unsigned int LUNASprite::GetVersion()
+{
+	return version;
 }
 
 LUNABlendingMode LUNASprite::GetBlendingMode()
 {
-	return material.blending;
+	return material.GetBlending();
 }
 
 void LUNASprite::SetBlendingMode(LUNABlendingMode blendingMode)
 {
-	material.blending = blendingMode;
+	uint32_t prevMaterial = material.GetHandle();
+	material.SetBlending(blendingMode);
+	if(material.GetHandle() != prevMaterial) version++;
 }
 
 float LUNASprite::GetX()
@@ -174,11 +201,17 @@ float LUNASprite::GetY()
 
 void LUNASprite::SetX(float x)
 {
+	if(this->x == x) return;
+
+	version++;
 	this->x = x;
 }
 
 void LUNASprite::SetY(float y)
 {
+	if(this->y == y) return;
+
+	version++;
 	this->y = y;
 }
 
@@ -205,11 +238,17 @@ float LUNASprite::GetHeight()
 
 void LUNASprite::SetWidth(float width)
 {
+	if(this->width == width) return;
+
+	version++;
 	this->width = width;
 }
 
 void LUNASprite::SetHeight(float height)
 {
+	if(this->height == height) return;
+
+	version++;
 	this->height = height;
 }
 
@@ -231,11 +270,17 @@ float LUNASprite::GetOriginY()
 
 void LUNASprite::SetOriginX(float originX)
 {
+	if(this->originX == originX) return;
+
+	version++;
 	this->originX = originX;
 }
 
 void LUNASprite::SetOriginY(float originY)
 {
+	if(this->originY == originY) return;
+
+	version++;
 	this->originY = originY;
 }
 
@@ -263,11 +308,17 @@ float LUNASprite::GetScaleY()
 
 void LUNASprite::SetScaleX(float scaleX)
 {
+	if(this->scaleX == scaleX) return;
+
+	version++;
 	this->scaleX = scaleX;
 }
 
 void LUNASprite::SetScaleY(float scaleY)
 {
+	if(this->scaleY == scaleY) return;
+
+	version++;
 	this->scaleY = scaleY;
 }
 
@@ -277,16 +328,43 @@ void LUNASprite::SetScale(float scale)
 	SetScaleY(scale);
 }
 
+// Get bounding rect of sprite on screen. For rotated sprite it's rect around circle containing all corners
+LUNARect LUNASprite::GetRenderBounds()
+{
+	float sizeX = width * scaleX;
+	float sizeY = height * scaleY;
+	float offsetX = originX * scaleX;
+	float offsetY = originY * scaleY;
+
+	if(angle == 0) return LUNARect(x + std::min(-offsetX, sizeX - offsetX), y + std::min(-offsetY, sizeY - offsetY),
+		std::abs(sizeX), std::abs(sizeY));
+
+	float maxX = std::max(std::abs(offsetX), std::abs(sizeX - offsetX));
+	float maxY = std::max(std::abs(offsetY), std::abs(sizeY - offsetY));
+	float radius = std::sqrt(maxX * maxX + maxY * maxY);
+
+	return LUNARect(x - radius, y - radius, radius * 2.0f, radius * 2.0f);
+}
+
 void LUNASprite::Render()
 {
-	if(material.texture.expired() || material.shader.expired())
+	if(!material.IsValid())
 	{
 		LUNA_LOGE("Attempt to render invalid sprite");
 		return;
 	}
 
 	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	if(!renderer->IsVisible(GetRenderBounds())) return;
+
+	LUNAVertex quad[4];
+	MakeQuad(quad);
+	renderer->RenderQuads(quad, 1, &material);
+}
 
+// Make vertexes of sprite quad. Doesn't change sprite, so can be called from worker threads
+void LUNASprite::MakeQuad(LUNAVertex* quad)
+{
 	// Sprite geometry
 	float x1 = 0;
 	float y1 = 0;
@@ -334,8 +412,10 @@ void LUNASprite::Render()
 		y4 = ry4;
 	}
 
-	renderer->RenderQuad(x + x1, y + y1, u1, v2, x + x2, y + y2, u1, v1, x + x3, y + y3, u2, v1, x + x4, y + y4, u2, v2,
-		&material, color);
+	quad[0] = LUNAVertex(x + x1, y + y1, u1, v2, color);
+	quad[1] = LUNAVertex(x + x2, y + y2, u1, v1, color);
+	quad[2] = LUNAVertex(x + x3, y + y3, u2, v1, color);
+	quad[3] = LUNAVertex(x + x4, y + y4, u2, v2, color);
 }
 
 // Get rotation angle (in degrees)
@@ -347,14 +427,23 @@ float LUNASprite::GetAngle()
 // Set rotation angle (in degrees)
 void LUNASprite::SetAngle(float angle)
 {
+	if(this->angle == angle) return;
+
+	version++;
 	this->angle = angle;
 }
 
 void LUNASprite::SetColor(float r, float g, float b)
 {
-	color.r = r / 255.0f;
-	color.g = g / 255.0f;
-	color.b = b / 255.0f;
+	r /= 255.0f;
+	g /= 255.0f;
+	b /= 255.0f;
+	if(color.r == r && color.g == g && color.b == b) return;
+
+	version++;
+	color.r = r;
+	color.g = g;
+	color.b = b;
 }
 
 LUNAColor LUNASprite::GetColor()
@@ -364,6 +453,9 @@ LUNAColor LUNASprite::GetColor()
 
 void LUNASprite::SetAlpha(float alpha)
 {
+	if(color.a == alpha) return;
+
+	version++;
 	color.a = alpha;
 }
 
@@ -28,6 +28,7 @@
 #include "lunacolor.h"
 #include "lunalua.h"
 #include "lunavector2.h"
+#include "lunavertex.h"
 
 namespace luna2d{
 
@@ -58,12 +59,24 @@ protected:
 	float u2 = 0;
 	float v2 = 0;
 	LUNAColor color = LUNAColor::WHITE;
+	unsigned int version = 0; // Changed on every change of sprite
 
 protected:
 	bool InitFromTexture(const std::weak_ptr<LUNATexture>& texture);
 	bool InitFromRegion(const std::weak_ptr<LUNATextureRegion>& region);
+	void SetUv(float u1, float v1, float u2, float v2); // Set texture coordinates
 
 public:
+	// Get bounding rect of sprite on screen. For rotated sprite it's rect around circle containing all corners
+	LUNARect GetRenderBounds();
+
+	// Make vertexes of sprite quad. Doesn't change sprite, so can be called from worker threads
+	void MakeQuad(LUNAVertex* quad);
+
+	const LUNAMaterial* GetMaterial();
+
+	unsigned int GetVersion(); // Version is incremented on every change of sprite
+
 	void SetTexture(const std::weak_ptr<LUNATexture>& texture);
 	void SetTextureRegion(const std::weak_ptr<LUNATextureRegion>& region);
 	void SetShader(const std::weak_ptr<LUNAShader>& shader);
@@ -0,0 +1,445 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunaspritebatch.h"
+#include "lunagraphics.h"
+#include "lunamath.h"
+
+using namespace luna2d;
+
+// Lua constructor
+LUNASpriteBatch::LUNASpriteBatch(const LuaAny& asset)
+{
+	// Create batch from texture
+	auto texture = asset.To<std::weak_ptr<LUNATexture>>();
+	if(!texture.expired())
+	{
+		auto sharedTexture = texture.lock();
+
+		material.SetTexture(texture);
+		regionWidth = sharedTexture->GetWidthPoints();
+		regionHeight = sharedTexture->GetHeightPoints();
+		regionU1 = LUNAVertex::PackUv(0.0f);
+		regionV1 = LUNAVertex::PackUv(0.0f);
+		regionU2 = LUNAVertex::PackUv(1.0f);
+		regionV2 = LUNAVertex::PackUv(1.0f);
+		return;
+	}
+
+	// Create batch from texture region
+	auto region = asset.To<std::weak_ptr<LUNATextureRegion>>();
+	if(GetRegion(region, regionWidth, regionHeight, regionU1, regionV1, regionU2, regionV2))
+	{
+		material.SetTexture(region.lock()->GetTexture());
+		return;
+	}
+
+	LUNA_LOGE("Attempt to create sprite batch from invalid asset");
+}
+
+bool LUNASpriteBatch::CheckIndex(int index)
+{
+	if(index < 1 || index > (int)x.size())
+	{
+		LUNA_LOGE("Sprite batch index \"%d\" is out of range", index);
+		return false;
+	}
+
+	return true;
+}
+
+bool LUNASpriteBatch::GetRegion(const std::weak_ptr<LUNATextureRegion>& region, float& width, float& height,
+	unsigned short& u1, unsigned short& v1, unsigned short& u2, unsigned short& v2)
+{
+	if(region.expired()) return false;
+
+	auto sharedRegion = region.lock();
+	if(sharedRegion->GetTexture().expired()) return false;
+
+	width = sharedRegion->GetWidthPoints();
+	height = sharedRegion->GetHeightPoints();
+	u1 = LUNAVertex::PackUv(sharedRegion->GetU1());
+	v1 = LUNAVertex::PackUv(sharedRegion->GetV1());
+	u2 = LUNAVertex::PackUv(sharedRegion->GetU2());
+	v2 = LUNAVertex::PackUv(sharedRegion->GetV2());
+	return true;
+}
+
+// Calculate corners of quads in range [first, last)
+// Arrays are passed as restricted pointers, because compiler doesn't vectorize loop
+// when outputs can alias inputs. Checked with GCC "-O3 -fopt-info-vec"
+static void TransformQuads(size_t first, size_t last,
+	const float* __restrict posX, const float* __restrict posY,
+	const float* __restrict sizeX, const float* __restrict sizeY,
+	const float* __restrict offsetX, const float* __restrict offsetY,
+	const float* __restrict factorX, const float* __restrict factorY,
+	const float* __restrict sin, const float* __restrict cos,
+	float* __restrict x1, float* __restrict y1, float* __restrict x2, float* __restrict y2,
+	float* __restrict x3, float* __restrict y3, float* __restrict x4, float* __restrict y4)
+{
+	// Corners of quad like:
+	// 2-3
+	// | |
+	// 1-4
+	for(size_t i = first; i < last; i++)
+	{
+		float left = -offsetX[i] * factorX[i];
+		float bottom = -offsetY[i] * factorY[i];
+		float right = left + sizeX[i] * factorX[i];
+		float top = bottom + sizeY[i] * factorY[i];
+
+		x1[i] = posX[i] + left * cos[i] - bottom * sin[i];
+		y1[i] = posY[i] + left * sin[i] + bottom * cos[i];
+		x2[i] = posX[i] + left * cos[i] - top * sin[i];
+		y2[i] = posY[i] + left * sin[i] + top * cos[i];
+		x3[i] = posX[i] + right * cos[i] - top * sin[i];
+		y3[i] = posY[i] + right * sin[i] + top * cos[i];
+		x4[i] = posX[i] + right * cos[i] - bottom * sin[i];
+		y4[i] = posY[i] + right * sin[i] + bottom * cos[i];
+	}
+}
+
+// Calculate corners of instances in range [first, last)
+void LUNASpriteBatch::TransformInstances(size_t first, size_t last)
+{
+	TransformQuads(first, last, &x[0], &y[0], &width[0], &height[0], &originX[0], &originY[0], &scaleX[0], &scaleY[0],
+		&sinAngle[0], &cosAngle[0], &cornersX[0][0], &cornersY[0][0], &cornersX[1][0], &cornersY[1][0],
+		&cornersX[2][0], &cornersY[2][0], &cornersX[3][0], &cornersY[3][0]);
+}
+
+// Make quads of visible instances in range [first, last) to vertex array starting from quad of first instance
+// Returns count of made quads
+size_t LUNASpriteBatch::MakeQuads(size_t first, size_t last, LUNARenderer* renderer)
+{
+	size_t quadsCount = 0;
+	for(size_t i = first; i < last; i++)
+	{
+		float minX = std::min(std::min(cornersX[0][i], cornersX[1][i]), std::min(cornersX[2][i], cornersX[3][i]));
+		float minY = std::min(std::min(cornersY[0][i], cornersY[1][i]), std::min(cornersY[2][i], cornersY[3][i]));
+		float maxX = std::max(std::max(cornersX[0][i], cornersX[1][i]), std::max(cornersX[2][i], cornersX[3][i]));
+		float maxY = std::max(std::max(cornersY[0][i], cornersY[1][i]), std::max(cornersY[2][i], cornersY[3][i]));
+		if(!renderer->IsInView(LUNARect(minX, minY, maxX - minX, maxY - minY))) continue;
+
+		// Texture coords of quad like:
+		// (u1,v1)-(u2,v1)
+		// |             |
+		// (u1,v2)-(u2,v2)
+		const unsigned short us[4] = { u1[i], u1[i], u2[i], u2[i] };
+		const unsigned short vs[4] = { v2[i], v1[i], v1[i], v2[i] };
+
+		LUNAVertex* quad = &vertexes[(first + quadsCount) * 4];
+		for(int j = 0; j < 4; j++)
+		{
+			quad[j].x = cornersX[j][i];
+			quad[j].y = cornersY[j][i];
+			quad[j].r = r[i];
+			quad[j].g = g[i];
+			quad[j].b = b[i];
+			quad[j].a = a[i];
+			quad[j].u = us[j];
+			quad[j].v = vs[j];
+		}
+
+		quadsCount++;
+	}
+
+	return quadsCount;
+}
+
+int LUNASpriteBatch::GetCount()
+{
+	return x.size();
+}
+
+// Add instance at given position with default region. Returns index of instance
+int LUNASpriteBatch::Add(float x, float y)
+{
+	this->x.push_back(x);
+	this->y.push_back(y);
+	width.push_back(regionWidth);
+	height.push_back(regionHeight);
+	originX.push_back(0);
+	originY.push_back(0);
+	scaleX.push_back(1);
+	scaleY.push_back(1);
+	angle.push_back(0);
+	sinAngle.push_back(0);
+	cosAngle.push_back(1);
+	u1.push_back(regionU1);
+	v1.push_back(regionV1);
+	u2.push_back(regionU2);
+	v2.push_back(regionV2);
+	r.push_back(255);
+	g.push_back(255);
+	b.push_back(255);
+	a.push_back(255);
+
+	return this->x.size();
+}
+
+// Add instances at given positions. Returns index of first added instance
+int LUNASpriteBatch::AddMany(const std::vector<glm::vec2>& positions)
+{
+	int firstIndex = x.size() + 1;
+	for(const auto& pos : positions) Add(pos.x, pos.y);
+
+	return firstIndex;
+}
+
+// Remove instance. Last instance is moved to given index
+void LUNASpriteBatch::Remove(int index)
+{
+	if(!CheckIndex(index)) return;
+
+	size_t i = index - 1;
+	size_t last = x.size() - 1;
+
+	x[i] = x[last];
+	y[i] = y[last];
+	width[i] = width[last];
+	height[i] = height[last];
+	originX[i] = originX[last];
+	originY[i] = originY[last];
+	scaleX[i] = scaleX[last];
+	scaleY[i] = scaleY[last];
+	angle[i] = angle[last];
+	sinAngle[i] = sinAngle[last];
+	cosAngle[i] = cosAngle[last];
+	u1[i] = u1[last];
+	v1[i] = v1[last];
+	u2[i] = u2[last];
+	v2[i] = v2[last];
+	r[i] = r[last];
+	g[i] = g[last];
+	b[i] = b[last];
+	a[i] = a[last];
+
+	x.pop_back();
+	y.pop_back();
+	width.pop_back();
+	height.pop_back();
+	originX.pop_back();
+	originY.pop_back();
+	scaleX.pop_back();
+	scaleY.pop_back();
+	angle.pop_back();
+	sinAngle.pop_back();
+	cosAngle.pop_back();
+	u1.pop_back();
+	v1.pop_back();
+	u2.pop_back();
+	v2.pop_back();
+	r.pop_back();
+	g.pop_back();
+	b.pop_back();
+	a.pop_back();
+}
+
+void LUNASpriteBatch::Clear()
+{
+	x.clear();
+	y.clear();
+	width.clear();
+	height.clear();
+	originX.clear();
+	originY.clear();
+	scaleX.clear();
+	scaleY.clear();
+	angle.clear();
+	sinAngle.clear();
+	cosAngle.clear();
+	u1.clear();
+	v1.clear();
+	u2.clear();
+	v2.clear();
+	r.clear();
+	g.clear();
+	b.clear();
+	a.clear();
+}
+
+glm::vec2 LUNASpriteBatch::GetPos(int index)
+{
+	if(!CheckIndex(index)) return glm::vec2();
+
+	return glm::vec2(x[index - 1], y[index - 1]);
+}
+
+void LUNASpriteBatch::SetPos(int index, float x, float y)
+{
+	if(!CheckIndex(index)) return;
+
+	this->x[index - 1] = x;
+	this->y[index - 1] = y;
+}
+
+void LUNASpriteBatch::SetPositions(int firstIndex, const std::vector<glm::vec2>& positions)
+{
+	if(positions.empty()) return;
+	if(!CheckIndex(firstIndex) || !CheckIndex(firstIndex + positions.size() - 1)) return;
+
+	for(size_t i = 0; i < positions.size(); i++)
+	{
+		x[firstIndex - 1 + i] = positions[i].x;
+		y[firstIndex - 1 + i] = positions[i].y;
+	}
+}
+
+void LUNASpriteBatch::SetSize(int index, float width, float height)
+{
+	if(!CheckIndex(index)) return;
+
+	this->width[index - 1] = width;
+	this->height[index - 1] = height;
+}
+
+void LUNASpriteBatch::SetOrigin(int index, float originX, float originY)
+{
+	if(!CheckIndex(index)) return;
+
+	this->originX[index - 1] = originX;
+	this->originY[index - 1] = originY;
+}
+
+void LUNASpriteBatch::SetScale(int index, float scaleX, float scaleY)
+{
+	if(!CheckIndex(index)) return;
+
+	this->scaleX[index - 1] = scaleX;
+	this->scaleY[index - 1] = scaleY;
+}
+
+// Get rotation angle (in degrees)
+float LUNASpriteBatch::GetAngle(int index)
+{
+	if(!CheckIndex(index)) return 0;
+
+	return angle[index - 1];
+}
+
+// Set rotation angle (in degrees)
+void LUNASpriteBatch::SetAngle(int index, float angle)
+{
+	if(!CheckIndex(index)) return;
+
+	float radians = math::DegreesToRadians(angle);
+	this->angle[index - 1] = angle;
+	sinAngle[index - 1] = std::sin(radians);
+	cosAngle[index - 1] = std::cos(radians);
+}
+
+void LUNASpriteBatch::SetAngles(int firstIndex, const std::vector<float>& angles)
+{
+	if(angles.empty()) return;
+	if(!CheckIndex(firstIndex) || !CheckIndex(firstIndex + angles.size() - 1)) return;
+
+	for(size_t i = 0; i < angles.size(); i++) SetAngle(firstIndex + i, angles[i]);
+}
+
+void LUNASpriteBatch::SetColor(int index, float r, float g, float b)
+{
+	if(!CheckIndex(index)) return;
+
+	this->r[index - 1] = LUNAVertex::PackColor(r / 255.0f);
+	this->g[index - 1] = LUNAVertex::PackColor(g / 255.0f);
+	this->b[index - 1] = LUNAVertex::PackColor(b / 255.0f);
+}
+
+void LUNASpriteBatch::SetAlpha(int index, float alpha)
+{
+	if(!CheckIndex(index)) return;
+
+	a[index - 1] = LUNAVertex::PackColor(alpha);
+}
+
+void LUNASpriteBatch::SetRegion(int index, const std::weak_ptr<LUNATextureRegion>& region)
+{
+	if(!CheckIndex(index)) return;
+
+	// All instances are rendered with one texture
+	auto sharedRegion = region.lock();
+	if(!sharedRegion || sharedRegion->GetTexture().lock() != material.GetTexture().lock())
+	{
+		LUNA_LOGE("Attempt to set invalid texture region to sprite batch. Region should belong to texture of batch");
+		return;
+	}
+
+	size_t i = index - 1;
+	GetRegion(region, width[i], height[i], u1[i], v1[i], u2[i], v2[i]);
+}
+
+void LUNASpriteBatch::SetShader(const std::weak_ptr<LUNAShader>& shader)
+{
+	if(shader.expired()) LUNA_RETURN_ERR("Attempt set invalid shader to sprite batch");
+
+	material.SetShader(shader);
+}
+
+LUNABlendingMode LUNASpriteBatch::GetBlendingMode()
+{
+	return material.GetBlending();
+}
+
+void LUNASpriteBatch::SetBlendingMode(LUNABlendingMode blendingMode)
+{
+	material.SetBlending(blendingMode);
+}
+
+void LUNASpriteBatch::Render()
+{
+	if(x.empty()) return;
+
+	if(!material.IsValid())
+	{
+		LUNA_LOGE("Attempt to render invalid sprite batch");
+		return;
+	}
+
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	size_t count = x.size();
+	size_t slicesCount = (count + SPRITEBATCH_JOB_SIZE - 1) / SPRITEBATCH_JOB_SIZE;
+
+	for(int i = 0; i < 4; i++)
+	{
+		cornersX[i].resize(count);
+		cornersY[i].resize(count);
+	}
+	vertexes.resize(count * 4);
+	sliceQuads.assign(slicesCount, 0);
+
+	// Each job makes quads of instances from own range to own slice of vertex array
+	renderer->BuildParallel(count, SPRITEBATCH_JOB_SIZE, [this, renderer](size_t first, size_t last)
+	{
+		TransformInstances(first, last);
+		sliceQuads[first / SPRITEBATCH_JOB_SIZE] = MakeQuads(first, last, renderer);
+	});
+
+	for(size_t i = 0; i < slicesCount; i++)
+	{
+		size_t first = i * SPRITEBATCH_JOB_SIZE;
+		size_t sliceCount = std::min(count - first, SPRITEBATCH_JOB_SIZE);
+
+		renderer->AddCulledObjects(sliceCount - sliceQuads[i]);
+		if(sliceQuads[i] > 0) renderer->RenderQuads(&vertexes[first * 4], sliceQuads[i], &material);
+	}
+}
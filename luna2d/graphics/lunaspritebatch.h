@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunatextureregion.h"
+#include "lunamaterial.h"
+#include "lunavertex.h"
+#include "lunavector2.h"
+
+namespace luna2d{
+
+const size_t SPRITEBATCH_JOB_SIZE = 1024; // Count of instances processed by one job of parallel build
+
+class LUNARenderer;
+
+//-----------------------------------------------------------------
+// Batch of sprite instances sharing one texture
+// Instances are stored as structure of arrays, so all quads
+// are made in one loop without per-sprite calls.
+// Removing instance moves last instance to index of removed one
+//-----------------------------------------------------------------
+class LUNASpriteBatch
+{
+	LUNA_USERDATA(LUNASpriteBatch)
+
+public:
+	LUNASpriteBatch(const LuaAny& asset); // Lua constructor
+
+private:
+	LUNAMaterial material;
+
+	// Default texture region for new instances
+	float regionWidth = 0;
+	float regionHeight = 0;
+	unsigned short regionU1 = 0;
+	unsigned short regionV1 = 0;
+	unsigned short regionU2 = 0;
+	unsigned short regionV2 = 0;
+
+	// Instances data
+	std::vector<float> x, y;
+	std::vector<float> width, height;
+	std::vector<float> originX, originY;
+	std::vector<float> scaleX, scaleY;
+	std::vector<float> angle;
+	std::vector<float> sinAngle, cosAngle; // Cached for given angle, so rendering doesn't need trigonometry
+	std::vector<unsigned short> u1, v1, u2, v2;
+	std::vector<unsigned char> r, g, b, a;
+
+	// Buffers for rendering. Corners of quads are calculated to separate arrays
+	// to allow compiler to vectorize transform loop
+	std::vector<float> cornersX[4], cornersY[4];
+	std::vector<LUNAVertex> vertexes;
+	std::vector<size_t> sliceQuads; // Count of visible quads in each slice of vertex array
+
+private:
+	bool CheckIndex(int index);
+	bool GetRegion(const std::weak_ptr<LUNATextureRegion>& region, float& width, float& height,
+		unsigned short& u1, unsigned short& v1, unsigned short& u2, unsigned short& v2);
+
+	// Calculate corners of instances in range [first, last)
+	void TransformInstances(size_t first, size_t last);
+
+	// Make quads of visible instances in range [first, last) to vertex array starting from quad of first instance
+	// Returns count of made quads
+	size_t MakeQuads(size_t first, size_t last, LUNARenderer* renderer);
+
+public:
+	int GetCount();
+
+	// Add instance at given position with default region. Returns index of instance
+	int Add(float x, float y);
+
+	// Add instances at given positions. Returns index of first added instance
+	int AddMany(const std::vector<glm::vec2>& positions);
+
+	// Remove instance. Last instance is moved to given index
+	void Remove(int index);
+	void Clear();
+
+	glm::vec2 GetPos(int index);
+	void SetPos(int index, float x, float y);
+	void SetPositions(int firstIndex, const std::vector<glm::vec2>& positions);
+	void SetSize(int index, float width, float height);
+	void SetOrigin(int index, float originX, float originY);
+	void SetScale(int index, float scaleX, float scaleY);
+	float GetAngle(int index); // Get rotation angle (in degrees)
+	void SetAngle(int index, float angle); // Set rotation angle (in degrees)
+	void SetAngles(int firstIndex, const std::vector<float>& angles);
+	void SetColor(int index, float r, float g, float b);
+	void SetAlpha(int index, float alpha);
+	void SetRegion(int index, const std::weak_ptr<LUNATextureRegion>& region);
+
+	void SetShader(const std::weak_ptr<LUNAShader>& shader);
+	LUNABlendingMode GetBlendingMode();
+	void SetBlendingMode(LUNABlendingMode blendingMode);
+
+	void Render();
+};
+
+}
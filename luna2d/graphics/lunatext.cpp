@@ -30,40 +30,81 @@ using namespace luna2d;
 LUNAText::LUNAText(const std::weak_ptr<LUNAFont>& font)
 {
 	SetFont(font);
-	mesh.SetShader(LUNAEngine::SharedGraphics()->GetRenderer()->GetFontShader());
 }
 
-void LUNAText::Build()
+// Layout is rebuilt only when text, font or layout params are changed
+void LUNAText::BuildLayout()
 {
-	mesh.Clear();
-
 	auto sharedFont = font.lock();
-	if(!sharedFont) LUNA_RETURN_ERR("Attemp to render invalid text object");
+	if(!sharedFont) LUNA_RETURN_ERR("Attemp to build layout of invalid text object");
+
+	// Version is got before build to make sure atlas of dynamic font is valid
+	fontGlyphsVersion = sharedFont->GetGlyphsVersion();
+	layout.Build(sharedFont.get(), text, maxWidth, align);
+	needUpload = true;
+	transformDirty = true;
+}
+
+// Upload quads of layout to vertex buffer
+void LUNAText::UploadBuffer()
+{
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	const auto& quads = layout.GetQuads();
+
+	if(!vertexBuffer) vertexBuffer = std::unique_ptr<LUNABufferObject>(new LUNABufferObject(LUNABufferType::VERTEX, LUNABufferUsage::STATIC));
 
-	float pointerX = 0;
-	height = 0;
-	width = 0;
+	// Buffer was lost with OpenGL context
+	else if(uploadedContextVersion != renderer->GetContextVersion()) vertexBuffer->Reload();
 
-	for(char32_t c : this->text)
+	// Quads of layout are white and opaque, so they don't need premultiplying
+	vertexBuffer->Bind();
+	vertexBuffer->SetData(&quads[0], quads.size() * sizeof(LUNAVertex));
+	vertexBuffer->Unbind();
+
+	uploadedContextVersion = renderer->GetContextVersion();
+	needUpload = false;
+}
+
+// Apply position, scale and color to quads of layout when buffers aren't used
+void LUNAText::UpdateVertexes()
+{
+	const auto& quads = layout.GetQuads();
+	vertexes.resize(quads.size());
+
+	unsigned char r = LUNAVertex::PackColor(color.r);
+	unsigned char g = LUNAVertex::PackColor(color.g);
+	unsigned char b = LUNAVertex::PackColor(color.b);
+	unsigned char a = LUNAVertex::PackColor(color.a);
+
+	for(size_t i = 0; i < quads.size(); i++)
 	{
-		const auto& glyph = sharedFont->GetGlyphForChar(c);
-		const auto& region = glyph.region;
-
-		mesh.AddQuad(x + pointerX + glyph.offsetX * scaleX, y + glyph.offsetY * scaleY,
-			region->GetWidthPoints() * scaleX,
-			region->GetHeightPoints() * scaleY,
-			region->GetU1(),
-			region->GetV1(),
-			region->GetU2(),
-			region->GetV2(),
-			color, color.a);
-
-		pointerX += glyph.width * scaleX;
-		width += glyph.width;
-		height = std::max(height, glyph.height);
+		LUNAVertex& vertex = vertexes[i];
+		vertex = quads[i];
+		vertex.x = x + vertex.x * scaleX;
+		vertex.y = y + vertex.y * scaleY;
+		vertex.r = r;
+		vertex.g = g;
+		vertex.b = b;
+		vertex.a = a;
 	}
 
-	dirty = false;
+	transformDirty = false;
+}
+
+LUNARect LUNAText::GetRenderBounds()
+{
+	const LUNARect& bounds = layout.GetBounds();
+	float x1 = x + bounds.x * scaleX;
+	float y1 = y + bounds.y * scaleY;
+	float x2 = x + (bounds.x + bounds.width) * scaleX;
+	float y2 = y + (bounds.y + bounds.height) * scaleY;
+
+	return LUNARect(std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1), std::abs(y2 - y1));
+}
+
+unsigned int LUNAText::GetVersion()
+{
+	return version;
 }
 
 float LUNAText::GetX()
@@ -93,9 +134,12 @@ glm::vec2 LUNAText::GetPos()
 
 void LUNAText::SetPos(float x, float y)
 {
+	if(this->x == x && this->y == y) return;
+
+	version++;
 	this->x = x;
 	this->y = y;
-	dirty = true;
+	transformDirty = true;
 }
 
 float LUNAText::GetScaleX()
@@ -110,14 +154,20 @@ float LUNAText::GetScaleY()
 
 void LUNAText::SetScaleX(float scaleX)
 {
+	if(this->scaleX == scaleX) return;
+
+	version++;
 	this->scaleX = scaleX;
-	dirty = true;
+	transformDirty = true;
 }
 
 void LUNAText::SetScaleY(float scaleY)
 {
+	if(this->scaleY == scaleY) return;
+
+	version++;
 	this->scaleY = scaleY;
-	dirty = true;
+	transformDirty = true;
 }
 
 void LUNAText::SetScale(float scale)
@@ -128,10 +178,16 @@ void LUNAText::SetScale(float scale)
 
 void LUNAText::SetColor(float r, float g, float b)
 {
-	color.r = r / 255.0f;
-	color.g = g / 255.0f;
-	color.b = b / 255.0f;
-	dirty = true;
+	r /= 255.0f;
+	g /= 255.0f;
+	b /= 255.0f;
+	if(color.r == r && color.g == g && color.b == b) return;
+
+	version++;
+	color.r = r;
+	color.g = g;
+	color.b = b;
+	transformDirty = true;
 }
 
 LUNAColor LUNAText::GetColor()
@@ -141,8 +197,11 @@ LUNAColor LUNAText::GetColor()
 
 void LUNAText::SetAlpha(float alpha)
 {
+	if(color.a == alpha) return;
+
+	version++;
 	color.a = alpha;
-	dirty = true;
+	transformDirty = true;
 }
 
 float LUNAText::GetAlpha()
@@ -158,24 +217,40 @@ void LUNAText::SetFont(const std::weak_ptr<LUNAFont>& font)
 		return;
 	}
 
+	auto sharedFont = font.lock();
+	if(sharedFont == this->font.lock()) return;
+
+	version++;
 	this->font = font;
-	mesh.SetTexture(font.lock()->GetTexture());
-	dirty = true;
+	material.SetTexture(sharedFont->GetTexture());
+	if(!customShader) material.SetShader(sharedFont->GetShader());
+	BuildLayout();
 }
 
 void LUNAText::SetShader(const std::weak_ptr<LUNAShader>& shader)
 {
-	mesh.SetShader(shader);
+	customShader = true;
+
+	uint32_t prevMaterial = material.GetHandle();
+	material.SetShader(shader);
+	if(material.GetHandle() != prevMaterial) version++;
 }
 
 float LUNAText::GetWidth()
 {
-	return width;
+	return layout.GetWidth();
 }
 
+// Get height of tallest glyph
 float LUNAText::GetHeight()
 {
-	return height;
+	return layout.GetGlyphsHeight();
+}
+
+// Get height of all lines
+float LUNAText::GetLinesHeight()
+{
+	return layout.GetHeight();
 }
 
 // Get text value in UTF-8 encoding
@@ -195,9 +270,48 @@ void LUNAText::SetText(const std::string& text)
 	}
 
 	// Convert given string from UTF-8 to UTF-32
-	this->text = utf::ToUtf32(text);
+	std::u32string newText = utf::ToUtf32(text);
+	if(newText == this->text) return;
 
-	Build();
+	version++;
+	this->text = std::move(newText);
+
+	BuildLayout();
+}
+
+float LUNAText::GetMaxWidth()
+{
+	return maxWidth;
+}
+
+// Set max width of line before scaling. Longer lines are wrapped by words
+void LUNAText::SetMaxWidth(float maxWidth)
+{
+	if(this->maxWidth == maxWidth) return;
+
+	version++;
+	this->maxWidth = maxWidth;
+	BuildLayout();
+}
+
+LUNATextAlign LUNAText::GetAlign()
+{
+	return align;
+}
+
+// Set alignment of lines in multi-line text
+void LUNAText::SetAlign(LUNATextAlign align)
+{
+	if(this->align == align) return;
+
+	version++;
+	this->align = align;
+	BuildLayout();
+}
+
+int LUNAText::GetLinesCount()
+{
+	return layout.GetLinesCount();
 }
 
 void LUNAText::Render()
@@ -210,7 +324,32 @@ void LUNAText::Render()
 
 	if(text.empty()) return;
 
-	if(dirty) Build();
+	// Glyphs of dynamic font can be evicted from atlas
+	auto sharedFont = font.lock();
+	if(sharedFont->IsDynamic())
+	{
+		if(fontGlyphsVersion != sharedFont->GetGlyphsVersion()) BuildLayout();
+		else sharedFont->TouchGlyphs(text);
+	}
+
+	const auto& quads = layout.GetQuads();
+	if(quads.empty()) return;
+
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	if(!renderer->IsVisible(GetRenderBounds())) return;
+
+	// Position, scale and color are applied in shader, so moving and fading text costs nothing on CPU
+	// Quads are drawn with shared quad indexes, so they should fit in 16-bit indexes
+	if(renderer->IsEnabledVertexBuffers() && quads.size() <= RENDER_MAX_BATCH_VERTEXES)
+	{
+		if(needUpload || uploadedContextVersion != renderer->GetContextVersion()) UploadBuffer();
+
+		size_t quadsCount = quads.size() / 4;
+		renderer->RenderBuffers(vertexBuffer.get(), renderer->GetQuadIndexBuffer(quadsCount), quads.size(), quadsCount * 6,
+			&material, glm::vec2(x, y), glm::vec2(scaleX, scaleY), &color);
+		return;
+	}
 
-	mesh.Render();
+	if(transformDirty) UpdateVertexes();
+	renderer->RenderQuads(&vertexes[0], vertexes.size() / 4, &material);
 }
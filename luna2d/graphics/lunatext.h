@@ -25,7 +25,8 @@
 
 #include "lunafont.h"
 #include "lunasprite.h"
-#include "lunamesh.h".h"
+#include "lunatextlayout.h"
+#include "lunabufferobject.h"
 
 namespace luna2d{
 
@@ -39,18 +40,33 @@ public:
 private:
 	std::weak_ptr<LUNAFont> font;
 	std::u32string text; // Text in UTF-32 encoding
-	LUNAMesh mesh;
+	LUNAMaterial material;
+	LUNATextLayout layout;
+
+	// Quads of layout are uploaded to own buffer once per build
+	// Position, scale and color are applied in shader, so changing them doesn't touch vertexes
+	std::unique_ptr<LUNABufferObject> vertexBuffer;
+	bool needUpload = true;
+	int uploadedContextVersion = 0;
+
+	std::vector<LUNAVertex> vertexes; // Quads of layout with applied position, scale and color. Used when buffers aren't used
 	float x = 0;
 	float y = 0;
 	float scaleX = 1;
 	float scaleY = 1;
-	float width = 0;
-	float height = 0;
+	float maxWidth = 0; // Max width of line before scaling. 0 means unlimited line
+	LUNATextAlign align = LUNATextAlign::LEFT;
 	LUNAColor color = LUNAColor::WHITE;
-	bool dirty = false;
+	bool transformDirty = false; // Vertexes for rendering without buffers should be updated because position, scale or color was changed
+	bool customShader = false; // Shader was set by user, so it isn't replaced by shader of font
+	unsigned int version = 0; // Changed on every change of text
+	unsigned int fontGlyphsVersion = 0; // Glyphs version of dynamic font on last build
 
 private:
-	void Build();
+	void BuildLayout(); // Layout is rebuilt only when text, font or layout params are changed
+	void UploadBuffer(); // Upload quads of layout to vertex buffer
+	void UpdateVertexes(); // Apply position, scale and color to quads of layout when buffers aren't used
+	LUNARect GetRenderBounds();
 
 public:
 	float GetX();
@@ -71,9 +87,18 @@ public:
 	void SetFont(const std::weak_ptr<LUNAFont>& font);
 	void SetShader(const std::weak_ptr<LUNAShader>& shader);
 	float GetWidth();
-	float GetHeight();
+	float GetHeight(); // Get height of tallest glyph
+	float GetLinesHeight(); // Get height of all lines
 	std::string GetText(); // Get text value in UTF-8 encoding
 	void SetText(const std::string& text); // Set text value. Given text in UTF-8 encoding
+	float GetMaxWidth();
+	void SetMaxWidth(float maxWidth); // Set max width of line before scaling. Longer lines are wrapped by words
+	LUNATextAlign GetAlign();
+	void SetAlign(LUNATextAlign align); // Set alignment of lines in multi-line text
+	int GetLinesCount();
+
+	unsigned int GetVersion(); // Version is incremented on every change of text
+
 	void Render();
 };
 
@@ -0,0 +1,187 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunatextlayout.h"
+
+using namespace luna2d;
+
+// Break text into lines by line breaks and by spaces to fit in "maxWidth". Zero "maxWidth" means unlimited line
+void LUNATextLayout::BreakLines(const std::u32string& text, float maxWidth)
+{
+	size_t begin = 0;
+
+	while(true)
+	{
+		float lineWidth = 0;
+		size_t spacePos = std::u32string::npos; // Position of last space in line
+		float spaceWidth = 0; // Width of line before last space
+		bool wrapped = false;
+		size_t i = begin;
+
+		for(; i < text.size() && text[i] != '\n'; i++)
+		{
+			float advance = glyphs[i].width;
+			if(i > begin) advance += kerning[i];
+
+			// Line has at least one char, so wrapping always moves forward
+			if(maxWidth > 0 && i > begin && text[i] != ' ' && lineWidth + advance > maxWidth)
+			{
+				wrapped = true;
+				break;
+			}
+
+			if(text[i] == ' ')
+			{
+				spacePos = i;
+				spaceWidth = lineWidth;
+			}
+
+			lineWidth += advance;
+		}
+
+		// Wrap at last space. Words longer than "maxWidth" are wrapped at char
+		if(wrapped && spacePos != std::u32string::npos && spacePos > begin)
+		{
+			lines.push_back(Line(begin, spacePos, spaceWidth));
+			begin = spacePos + 1;
+		}
+		else if(wrapped)
+		{
+			lines.push_back(Line(begin, i, lineWidth));
+			begin = i;
+		}
+		else
+		{
+			lines.push_back(Line(begin, i, lineWidth));
+			if(i >= text.size()) break;
+			begin = i + 1; // Skip line break
+		}
+	}
+}
+
+void LUNATextLayout::AddQuad(float x, float y, float width, float height, float u1, float v1, float u2, float v2)
+{
+	quads.push_back(LUNAVertex(x, y, u1, v2, LUNAColor::WHITE));
+	quads.push_back(LUNAVertex(x, y + height, u1, v1, LUNAColor::WHITE));
+	quads.push_back(LUNAVertex(x + width, y + height, u2, v1, LUNAColor::WHITE));
+	quads.push_back(LUNAVertex(x + width, y, u2, v2, LUNAColor::WHITE));
+
+	float minX = std::min(bounds.x, x);
+	float minY = std::min(bounds.y, y);
+	float maxX = std::max(bounds.x + bounds.width, x + width);
+	float maxY = std::max(bounds.y + bounds.height, y + height);
+	bounds = LUNARect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void LUNATextLayout::Build(LUNAFont* font, const std::u32string& text, float maxWidth, LUNATextAlign align)
+{
+	Clear();
+	if(text.empty()) return;
+
+	// Fetch glyphs and kerning once, so breaking and placing are linear scans over arrays
+	glyphs.resize(text.size());
+	kerning.resize(text.size());
+	for(size_t i = 0; i < text.size(); i++)
+	{
+		glyphs[i] = font->GetGlyphForChar(text[i]);
+		kerning[i] = i > 0 ? font->GetKerning(text[i - 1], text[i]) : 0;
+		glyphsHeight = std::max(glyphsHeight, glyphs[i].height);
+	}
+
+	BreakLines(text, maxWidth);
+
+	float lineHeight = font->GetLineHeight();
+
+	for(const auto& line : lines) width = std::max(width, line.width);
+	height = lines.size() * lineHeight;
+
+	for(size_t i = 0; i < lines.size(); i++)
+	{
+		const Line& line = lines[i];
+
+		float penX = 0;
+		if(align == LUNATextAlign::CENTER) penX = (width - line.width) / 2.0f;
+		else if(align == LUNATextAlign::RIGHT) penX = width - line.width;
+
+		// First line is on top
+		float penY = (lines.size() - i - 1) * lineHeight;
+
+		for(size_t j = line.begin; j < line.end; j++)
+		{
+			if(j > line.begin) penX += kerning[j];
+
+			const LUNAGlyph& glyph = glyphs[j];
+
+			// Skip quads of whitespaces
+			if(glyph.quadWidth > 0 && glyph.quadHeight > 0)
+			{
+				AddQuad(penX + glyph.offsetX, penY + glyph.offsetY, glyph.quadWidth, glyph.quadHeight,
+					glyph.u1, glyph.v1, glyph.u2, glyph.v2);
+			}
+
+			penX += glyph.width;
+		}
+	}
+}
+
+void LUNATextLayout::Clear()
+{
+	quads.clear();
+	lines.clear();
+	bounds = LUNARect();
+	width = 0;
+	height = 0;
+	glyphsHeight = 0;
+}
+
+const std::vector<LUNAVertex>& LUNATextLayout::GetQuads() const
+{
+	return quads;
+}
+
+const LUNARect& LUNATextLayout::GetBounds() const
+{
+	return bounds;
+}
+
+float LUNATextLayout::GetWidth() const
+{
+	return width;
+}
+
+// Get height of all lines
+float LUNATextLayout::GetHeight() const
+{
+	return height;
+}
+
+// Get height of tallest glyph
+float LUNATextLayout::GetGlyphsHeight() const
+{
+	return glyphsHeight;
+}
+
+int LUNATextLayout::GetLinesCount() const
+{
+	return lines.size();
+}
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunafont.h"
+#include "lunavertex.h"
+#include "lunarect.h"
+#include "lunastringenum.h"
+
+namespace luna2d{
+
+enum class LUNATextAlign
+{
+	LEFT,
+	CENTER,
+	RIGHT,
+};
+
+const LUNAStringEnum<LUNATextAlign> TEXT_ALIGN =
+{
+	"left",
+	"center",
+	"right",
+};
+
+template<>
+struct LuaStack<LUNATextAlign>
+{
+	static void Push(lua_State* luaVm, const LUNATextAlign& align)
+	{
+		LuaStack<std::string>::Push(luaVm, TEXT_ALIGN.FromEnum(align));
+	}
+
+	static LUNATextAlign Pop(lua_State* luaVm, int index = -1)
+	{
+		auto strAlign = LuaStack<std::string>::Pop(luaVm, index);
+		return TEXT_ALIGN.FromString(strAlign, LUNATextAlign::LEFT);
+	}
+};
+
+//---------------------------------------------------------------
+// Layout of text: glyph quads broken into lines and aligned.
+// Quads are stored relative to bottom-left corner of text without
+// position, scale and color, so layout is rebuilt only when text,
+// font or layout params are changed
+//---------------------------------------------------------------
+class LUNATextLayout
+{
+private:
+	struct Line
+	{
+		Line(size_t begin, size_t end, float width) : begin(begin), end(end), width(width) {}
+
+		size_t begin; // Index of first char of line
+		size_t end; // Index after last char of line
+		float width;
+	};
+
+	std::vector<LUNAVertex> quads; // 4 vertexes for each visible glyph in same order as in "LUNARenderer::RenderQuad"
+	std::vector<Line> lines;
+	std::vector<LUNAGlyph> glyphs; // Glyph for each char of text. Fetched from font once per build
+	std::vector<float> kerning; // Kerning offset between each char and previous char
+	LUNARect bounds; // Bounding rect of all quads
+	float width = 0;
+	float height = 0; // Height of all lines
+	float glyphsHeight = 0; // Height of tallest glyph
+
+private:
+	// Break text into lines by line breaks and by spaces to fit in "maxWidth". Zero "maxWidth" means unlimited line
+	void BreakLines(const std::u32string& text, float maxWidth);
+
+	void AddQuad(float x, float y, float width, float height, float u1, float v1, float u2, float v2);
+
+public:
+	void Build(LUNAFont* font, const std::u32string& text, float maxWidth, LUNATextAlign align);
+	void Clear();
+
+	const std::vector<LUNAVertex>& GetQuads() const;
+	const LUNARect& GetBounds() const;
+	float GetWidth() const;
+	float GetHeight() const; // Get height of all lines
+	float GetGlyphsHeight() const; // Get height of tallest glyph
+	int GetLinesCount() const;
+};
+
+}
@@ -24,6 +24,7 @@
 #include "lunatexture.h"
 #include "lunasizes.h"
 #include "lunalog.h"
+#include "lunaglstate.h"
 
 using namespace luna2d;
 
@@ -43,7 +44,7 @@ LUNATexture::LUNATexture(int width, int height, LUNAColorType colorType) :
 	colorType(colorType)
 {
 	glGenTextures(1, &id);
-	glBindTexture(GL_TEXTURE_2D, id);
+	LUNAGlState::BindTexture(id);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -51,11 +52,12 @@ LUNATexture::LUNATexture(int width, int height, LUNAColorType colorType) :
 	GLint glColorType = ToGlColorType(colorType);
 	glTexImage2D(GL_TEXTURE_2D, 0, glColorType, width, height, 0, glColorType, GL_UNSIGNED_BYTE, 0);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LUNAGlState::BindTexture(0);
 }
 
 LUNATexture::~LUNATexture()
 {
+	LUNAGlState::OnDeleteTexture(id);
 	glDeleteTextures(1, &id);
 
 #if LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
@@ -68,7 +70,7 @@ LUNATexture::~LUNATexture()
 void LUNATexture::InitFromImageData(const std::vector<unsigned char>& data)
 {
 	glGenTextures(1, &id);
-	glBindTexture(GL_TEXTURE_2D, id);
+	LUNAGlState::BindTexture(id);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -76,7 +78,7 @@ void LUNATexture::InitFromImageData(const std::vector<unsigned char>& data)
 	GLint glColorType = ToGlColorType(colorType);
 	glTexImage2D(GL_TEXTURE_2D, 0, glColorType, width, height, 0, glColorType, GL_UNSIGNED_BYTE, &data[0]);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LUNAGlState::BindTexture(0);
 }
 
 // Get sizes in pixels
@@ -114,30 +116,66 @@ bool LUNATexture::IsValid() const
 
 void LUNATexture::SetNearestFilter()
 {
-	glBindTexture(GL_TEXTURE_2D, id);
+	LUNAGlState::BindTexture(id);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LUNAGlState::BindTexture(0);
 }
 
 void LUNATexture::SetLinearFilter()
 {
-	glBindTexture(GL_TEXTURE_2D, id);
+	LUNAGlState::BindTexture(id);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LUNAGlState::BindTexture(0);
+}
+
+// Recreate texture from given image, e.g. after loss of GL context
+// Image should have same sizes and color type as texture
+void LUNATexture::Recreate(const LUNAImage& image)
+{
+	if(image.GetWidth() != width || image.GetHeight() != height || image.GetColorType() != colorType)
+	{
+		LUNA_LOGE("Image for recreating texture should have same sizes and color type as texture");
+		return;
+	}
+
+	// Old texture object can still exist if context wasn't lost
+	if(glIsTexture(id) == GL_TRUE)
+	{
+		LUNAGlState::OnDeleteTexture(id);
+		glDeleteTextures(1, &id);
+	}
+
+	InitFromImageData(image.GetData());
+}
+
+// Update part of texture. Given pixels should have same color type as texture
+void LUNATexture::UpdateRegion(int x, int y, int width, int height, const unsigned char* data)
+{
+	LUNAGlState::BindTexture(id);
+
+	// Rows of region can be not aligned to 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	GLint glColorType = ToGlColorType(colorType);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, glColorType, GL_UNSIGNED_BYTE, data);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	LUNAGlState::BindTexture(0);
 }
 
 void LUNATexture::Bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, id);
+	LUNAGlState::BindTexture(id);
 }
 
 void LUNATexture::Unbind() const
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	LUNAGlState::BindTexture(0);
 }
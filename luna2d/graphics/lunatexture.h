@@ -27,6 +27,7 @@
 #include "lunaglhelpers.h"
 #include "lunaimage.h"
 #include "lunaassets.h"
+#include "lunaconfig.h"
 
 namespace luna2d{
 
@@ -66,6 +67,13 @@ public:
 	void SetNearestFilter();
 	void SetLinearFilter();
 
+	// Recreate texture from given image, e.g. after loss of GL context
+	// Image should have same sizes and color type as texture
+	void Recreate(const LUNAImage& image);
+
+	// Update part of texture. Given pixels should have same color type as texture
+	void UpdateRegion(int x, int y, int width, int height, const unsigned char* data);
+
 	void Bind() const;
 	void Unbind() const;
 
@@ -118,6 +126,7 @@ public:
 				LUNAImage image(reloadPath, *format, LUNAFileLocation::ASSETS);
 				if(!image.IsEmpty())
 				{
+					if(LUNAEngine::Shared()->GetConfig()->premultipliedAlpha) image.PremultiplyAlpha();
 					InitFromImageData(image.GetData());
 					return;
 				}
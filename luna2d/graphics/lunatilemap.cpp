@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunatilemap.h"
+#include "lunagraphics.h"
+
+using namespace luna2d;
+
+LUNATileMap::LUNATileMap(const std::vector<std::weak_ptr<LUNATextureRegion>>& tileset, int columns, int rows,
+	float tileWidth, float tileHeight) :
+	columns(std::max(columns, 0)),
+	rows(std::max(rows, 0)),
+	tileWidth(tileWidth),
+	tileHeight(tileHeight)
+{
+	tiles.resize(this->columns * this->rows, 0);
+	chunkColumns = (this->columns + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+	chunkRows = (this->rows + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+	chunks.resize(chunkColumns * chunkRows);
+
+	// All tiles should be regions of one texture
+	for(const auto& region : tileset)
+	{
+		auto sharedRegion = region.lock();
+		if(!sharedRegion) LUNA_RETURN_ERR("Attempt to create tile map with invalid texture region");
+
+		auto regionTexture = sharedRegion->GetTexture().lock();
+		if(!regionTexture) LUNA_RETURN_ERR("Attempt to create tile map with invalid texture region");
+
+		if(texture.expired()) texture = regionTexture;
+		else if(texture.lock() != regionTexture) LUNA_RETURN_ERR("All regions of tile map should have same texture");
+
+		this->tileset.push_back({ sharedRegion->GetU1(), sharedRegion->GetV1(), sharedRegion->GetU2(), sharedRegion->GetV2() });
+	}
+}
+
+bool LUNATileMap::CheckTile(int column, int row)
+{
+	if(column < 1 || column > columns || row < 1 || row > rows)
+	{
+		LUNA_LOGE("Tile (%d, %d) is out of range", column, row);
+		return false;
+	}
+
+	return true;
+}
+
+// Get chunk containing tile with given zero-based indexes
+LUNATileMap::Chunk& LUNATileMap::GetChunk(int column, int row)
+{
+	return chunks[(row / TILEMAP_CHUNK_SIZE) * chunkColumns + column / TILEMAP_CHUNK_SIZE];
+}
+
+void LUNATileMap::BuildChunk(int chunkColumn, int chunkRow)
+{
+	Chunk& chunk = chunks[chunkRow * chunkColumns + chunkColumn];
+
+	if(!chunk.mesh)
+	{
+		chunk.mesh = std::unique_ptr<LUNAMesh>(new LUNAMesh(texture));
+		chunk.mesh->SetStatic(true);
+		if(!shader.expired()) chunk.mesh->SetShader(shader);
+	}
+
+	chunk.mesh->Clear();
+	chunk.dirty = false;
+
+	int firstColumn = chunkColumn * TILEMAP_CHUNK_SIZE;
+	int firstRow = chunkRow * TILEMAP_CHUNK_SIZE;
+	int lastColumn = std::min(firstColumn + TILEMAP_CHUNK_SIZE, columns);
+	int lastRow = std::min(firstRow + TILEMAP_CHUNK_SIZE, rows);
+
+	for(int row = firstRow; row < lastRow; row++)
+	{
+		for(int column = firstColumn; column < lastColumn; column++)
+		{
+			int tile = tiles[row * columns + column];
+			if(tile < 1 || tile > (int)tileset.size()) continue;
+
+			const Tile& region = tileset[tile - 1];
+			chunk.mesh->AddQuad(column * tileWidth, row * tileHeight, tileWidth, tileHeight,
+				region.u1, region.v1, region.u2, region.v2, LUNAColor::WHITE, 1.0f);
+		}
+	}
+}
+
+void LUNATileMap::MarkAllChunksDirty()
+{
+	for(auto& chunk : chunks) chunk.dirty = true;
+}
+
+int LUNATileMap::GetColumns()
+{
+	return columns;
+}
+
+int LUNATileMap::GetRows()
+{
+	return rows;
+}
+
+glm::vec2 LUNATileMap::GetPos()
+{
+	return pos;
+}
+
+void LUNATileMap::SetPos(float x, float y)
+{
+	// Chunks are built in map coordinates, so moving of map doesn't rebuild them
+	pos.x = x;
+	pos.y = y;
+}
+
+int LUNATileMap::GetTile(int column, int row)
+{
+	if(!CheckTile(column, row)) return 0;
+
+	return tiles[(row - 1) * columns + column - 1];
+}
+
+void LUNATileMap::SetTile(int column, int row, int tile)
+{
+	if(!CheckTile(column, row)) return;
+
+	int& curTile = tiles[(row - 1) * columns + column - 1];
+	if(curTile == tile) return;
+
+	curTile = tile;
+	GetChunk(column - 1, row - 1).dirty = true;
+}
+
+// Set all tiles by rows, starting from bottom row
+void LUNATileMap::SetTiles(const std::vector<int>& tiles)
+{
+	if(tiles.size() != this->tiles.size())
+	{
+		LUNA_LOGE("Count of tiles should be %d", (int)this->tiles.size());
+		return;
+	}
+
+	this->tiles = tiles;
+	MarkAllChunksDirty();
+}
+
+void LUNATileMap::SetShader(const std::weak_ptr<LUNAShader>& shader)
+{
+	if(shader.expired()) LUNA_RETURN_ERR("Attempt set invalid shader to tile map");
+
+	this->shader = shader;
+	for(auto& chunk : chunks)
+	{
+		if(chunk.mesh) chunk.mesh->SetShader(shader);
+	}
+}
+
+void LUNATileMap::Render()
+{
+	if(chunks.empty()) return;
+
+	if(texture.expired())
+	{
+		LUNA_LOGE("Attempt to render invalid tile map");
+		return;
+	}
+
+	int firstColumn = 0;
+	int firstRow = 0;
+	int lastColumn = chunkColumns - 1;
+	int lastRow = chunkRows - 1;
+
+	// Find range of chunks visible by camera
+	auto graphics = LUNAEngine::SharedGraphics();
+	if(graphics->GetRenderer()->IsEnabledCulling())
+	{
+		const LUNARect& view = graphics->GetCamera()->GetViewRect();
+		float chunkWidth = tileWidth * TILEMAP_CHUNK_SIZE;
+		float chunkHeight = tileHeight * TILEMAP_CHUNK_SIZE;
+
+		firstColumn = std::max(firstColumn, (int)std::floor((view.x - pos.x) / chunkWidth));
+		firstRow = std::max(firstRow, (int)std::floor((view.y - pos.y) / chunkHeight));
+		lastColumn = std::min(lastColumn, (int)std::floor((view.x + view.width - pos.x) / chunkWidth));
+		lastRow = std::min(lastRow, (int)std::floor((view.y + view.height - pos.y) / chunkHeight));
+	}
+
+	for(int row = firstRow; row <= lastRow; row++)
+	{
+		for(int column = firstColumn; column <= lastColumn; column++)
+		{
+			Chunk& chunk = chunks[row * chunkColumns + column];
+			if(chunk.dirty) BuildChunk(column, row);
+
+			chunk.mesh->RenderWithOffset(pos);
+		}
+	}
+}
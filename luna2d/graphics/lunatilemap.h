@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunamesh.h"
+#include "lunatextureregion.h"
+
+namespace luna2d{
+
+const int TILEMAP_CHUNK_SIZE = 16; // Size of chunk side in tiles
+
+//-------------------------------------------------------------------
+// Grid of tiles rendered by chunks
+// Each chunk is baked into static mesh in map coordinates. Only chunks
+// visible by camera are rendered, and changing tile rebuilds only its chunk.
+// Tiles are regions of one texture (usually regions of texture atlas)
+// Column 1, row 1 is bottom-left tile of map. Tile "0" is empty
+//-------------------------------------------------------------------
+class LUNATileMap
+{
+	LUNA_USERDATA(LUNATileMap)
+
+public:
+	LUNATileMap(const std::vector<std::weak_ptr<LUNATextureRegion>>& tileset, int columns, int rows,
+		float tileWidth, float tileHeight);
+
+private:
+	struct Chunk
+	{
+		std::unique_ptr<LUNAMesh> mesh;
+		bool dirty = true;
+	};
+
+	struct Tile
+	{
+		float u1, v1, u2, v2;
+	};
+
+private:
+	std::weak_ptr<LUNATexture> texture;
+	std::weak_ptr<LUNAShader> shader;
+	std::vector<Tile> tileset;
+	std::vector<int> tiles; // Tile ids by rows
+	std::vector<Chunk> chunks;
+	int columns, rows;
+	int chunkColumns, chunkRows;
+	float tileWidth, tileHeight;
+	glm::vec2 pos;
+
+private:
+	bool CheckTile(int column, int row);
+	Chunk& GetChunk(int column, int row); // Get chunk containing tile with given zero-based indexes
+	void BuildChunk(int chunkColumn, int chunkRow);
+	void MarkAllChunksDirty();
+
+public:
+	int GetColumns();
+	int GetRows();
+	glm::vec2 GetPos();
+	void SetPos(float x, float y);
+	int GetTile(int column, int row);
+	void SetTile(int column, int row, int tile);
+	void SetTiles(const std::vector<int>& tiles); // Set all tiles by rows, starting from bottom row
+	void SetShader(const std::weak_ptr<LUNAShader>& shader);
+	void Render();
+};
+
+}
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "lunacolor.h"
+
+namespace luna2d{
+
+//-------------------------------------------------------
+// Packed vertex format using for batch rendering
+// Color stored as 4 normalized bytes and texture coords
+// as 2 normalized shorts, so vertex takes 16 bytes
+//-------------------------------------------------------
+struct LUNAVertex
+{
+	LUNAVertex() {}
+
+	LUNAVertex(float x, float y, float r, float g, float b, float a, float u, float v) :
+		x(x), y(y), r(PackColor(r)), g(PackColor(g)), b(PackColor(b)), a(PackColor(a)), u(PackUv(u)), v(PackUv(v)) {}
+
+	LUNAVertex(float x, float y, float u, float v, const LUNAColor& color) :
+		LUNAVertex(x, y, color.r, color.g, color.b, color.a, u, v) {}
+
+	// Position
+	float x = 0.0f;
+	float y = 0.0f;
+
+	// Color
+	unsigned char r = 0;
+	unsigned char g = 0;
+	unsigned char b = 0;
+	unsigned char a = 0;
+
+	// Texture coordinates
+	unsigned short u = 0;
+	unsigned short v = 0;
+
+	// Convert color component from float format(0.0f-1.0f) to byte format(0-255)
+	inline static unsigned char PackColor(float value)
+	{
+		return (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	// Convert texture coordinate from float format(0.0f-1.0f) to short format(0-65535)
+	inline static unsigned short PackUv(float value)
+	{
+		return (unsigned short)(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+	}
+};
+
+static_assert(sizeof(LUNAVertex) == 16, "Vertex should be tightly packed");
+
+//-------------------------------------------------------
+// Per-vertex attributes needed only by some batches
+// Stored in separate vertex stream which is filled only
+// for such batches, so other batches don't upload them
+//-------------------------------------------------------
+struct LUNAVertexExtra
+{
+	// Index of texture in batch with several textures
+	unsigned char slot = 0;
+	unsigned char reserved = 0;
+
+	// Depth of vertex as normalized short. Used only by opaque pass
+	unsigned short depth = 0;
+};
+
+static_assert(sizeof(LUNAVertexExtra) == 4, "Extra vertex attributes should be tightly packed");
+
+}
@@ -252,6 +252,18 @@ void LUNAParticleEmitter::Stop()
 	for(auto& subsystem : subsystems) subsystem->Stop();
 }
 
+// Render made quads of given count of particles starting from given particle
+void LUNAParticleEmitter::RenderParticles(size_t first, size_t count, const LUNAMaterial* material)
+{
+	if(!material->IsValid())
+	{
+		LUNA_LOGE("Attempt to render invalid sprite");
+		return;
+	}
+
+	LUNAEngine::SharedGraphics()->GetRenderer()->RenderQuads(&quads[first * 4], count, material);
+}
+
 void LUNAParticleEmitter::Update(float dt)
 {
 	UpdateDuration(dt);
@@ -269,5 +281,50 @@ void LUNAParticleEmitter::Render()
 		for(auto& particle : particles) particle->RenderSubparticles();
 	}
 
-	for(auto& particle : particles) particle->Render();
+	// Quads of particles are made in parallel, then consecutive visible particles
+	// with same material are rendered together
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	size_t count = particles.size();
+	quads.resize(count * 4);
+	visibleParticles.resize(count);
+
+	renderer->BuildParallel(count, PARTICLES_JOB_SIZE, [this, renderer](size_t first, size_t last)
+	{
+		for(size_t i = first; i < last; i++)
+		{
+			visibleParticles[i] = renderer->IsInView(particles[i]->GetRenderBounds());
+			if(visibleParticles[i]) particles[i]->MakeQuad(&quads[i * 4]);
+		}
+	});
+
+	const LUNAMaterial* runMaterial = nullptr;
+	size_t runFirst = 0;
+	size_t runCount = 0;
+	int culled = 0;
+
+	for(size_t i = 0; i <= count; i++)
+	{
+		const LUNAMaterial* material = nullptr;
+		if(i < count)
+		{
+			if(visibleParticles[i]) material = particles[i]->GetMaterial();
+			else culled++;
+		}
+
+		if(runCount > 0 && (!material || *material != *runMaterial))
+		{
+			RenderParticles(runFirst, runCount, runMaterial);
+			runCount = 0;
+		}
+
+		if(!material) continue;
+		if(runCount == 0)
+		{
+			runFirst = i;
+			runMaterial = material;
+		}
+		runCount++;
+	}
+
+	renderer->AddCulledObjects(culled);
 }
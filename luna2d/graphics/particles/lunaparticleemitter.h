@@ -29,6 +29,8 @@
 
 namespace luna2d{
 
+const size_t PARTICLES_JOB_SIZE = 256; // Count of particles processed by one job of parallel build
+
 class LUNAParticleEmitter
 {
 public:
@@ -39,6 +41,10 @@ private:
 	std::vector<std::shared_ptr<LUNASprite>> sourceSprites;
 	std::vector<std::shared_ptr<LUNAParticle>> particles;
 
+	// Buffers for rendering particles
+	std::vector<LUNAVertex> quads;
+	std::vector<unsigned char> visibleParticles;
+
 	std::unordered_set<std::shared_ptr<LUNAParticleSystem>> subsystems;
 
 	glm::vec2 pos;
@@ -55,6 +61,9 @@ private:
 	void UpdateEmit(float dt);
 	void UpdateParticles(float dt);
 
+	// Render made quads of given count of particles starting from given particle
+	void RenderParticles(size_t first, size_t count, const LUNAMaterial* material);
+
 public:
 	bool IsFinished();
 	glm::vec2 GetPos();
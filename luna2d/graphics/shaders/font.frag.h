@@ -37,3 +37,45 @@ void main()
 	gl_FragColor = v_color * vec4(1.0, 1.0, 1.0, texture2D(u_texture, v_texCoords).a);
 })";
 
+//----------------------------------------------------------
+// Fragment shader for fonts in premultiplied alpha mode
+// Vertex color is premultiplied, so all components are
+// multiplied by glyph alpha
+//----------------------------------------------------------
+const std::string FONT_PREMULTIPLIED_FRAG_SHADER =
+R"(uniform sampler2D u_texture;
+
+varying lowp vec4 v_color;
+varying vec2 v_texCoords;
+
+void main()
+{
+	gl_FragColor = v_color * texture2D(u_texture, v_texCoords).a;
+})";
+
+//----------------------------------------------------------
+// Fragment shader for fonts baked as signed distance field
+// Texture alpha 0.5 is edge of glyph. Outline fonts use
+// lower edge threshold, it's set by "SDF_THRESHOLD" define.
+// "PREMULTIPLIED_ALPHA" is defined in premultiplied mode
+//----------------------------------------------------------
+const std::string FONT_SDF_FRAG_SHADER =
+R"(uniform sampler2D u_texture;
+
+varying lowp vec4 v_color;
+varying vec2 v_texCoords;
+
+const float SMOOTHING = 1.0 / 16.0;
+
+void main()
+{
+	float dist = texture2D(u_texture, v_texCoords).a;
+	float alpha = smoothstep(SDF_THRESHOLD - SMOOTHING, SDF_THRESHOLD + SMOOTHING, dist);
+
+#ifdef PREMULTIPLIED_ALPHA
+	gl_FragColor = v_color * alpha;
+#else
+	gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+#endif
+})";
+
@@ -30,10 +30,13 @@ const std::string FONT_VERT_SHADER =
 R"(uniform mat4 u_transformMatrix;
 
 attribute vec4 a_position;
-attribute vec4 a_color;
+attribute lowp vec4 a_color; // Normalized from unsigned bytes
 attribute vec2 a_texCoords;
+#ifdef DEPTH_PASS
+attribute float a_depth; // Normalized from unsigned short. Declared only in variant used by opaque pass
+#endif
 
-varying vec4 v_color;
+varying lowp vec4 v_color;
 varying vec2 v_texCoords;
 
 void main()
@@ -41,4 +44,7 @@ void main()
 	v_color = a_color;
 	v_texCoords = a_texCoords;
 	gl_Position = u_transformMatrix * a_position;
+#ifdef DEPTH_PASS
+	gl_Position.z = (a_depth * 2.0 - 1.0) * gl_Position.w;
+#endif
 })";
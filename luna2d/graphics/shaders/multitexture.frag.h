@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+//-----------------------------------------------------------------
+// Fragment shader for batches with several textures
+// GLSL ES 1.0 doesn't allow dynamic indexing of sampler arrays,
+// so texture is selected by constant index.
+// Count of samplers should match "RENDER_TEXTURE_SLOTS"
+//-----------------------------------------------------------------
+const std::string MULTITEXTURE_FRAG_SHADER =
+R"(uniform sampler2D u_textures[4];
+
+varying lowp vec4 v_color;
+varying vec2 v_texCoords;
+varying float v_texSlot;
+
+void main()
+{
+	lowp vec4 texColor;
+	if(v_texSlot < 0.5) texColor = texture2D(u_textures[0], v_texCoords);
+	else if(v_texSlot < 1.5) texColor = texture2D(u_textures[1], v_texCoords);
+	else if(v_texSlot < 2.5) texColor = texture2D(u_textures[2], v_texCoords);
+	else texColor = texture2D(u_textures[3], v_texCoords);
+
+	gl_FragColor = v_color * texColor;
+})";
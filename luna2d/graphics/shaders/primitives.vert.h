@@ -30,9 +30,9 @@ const std::string PRIMITIVES_VERT_SHADER =
 R"(uniform mat4 u_transformMatrix;
 
 attribute vec4 a_position;
-attribute vec4 a_color;
+attribute lowp vec4 a_color; // Normalized from unsigned bytes
 
-varying vec4 v_color;
+varying lowp vec4 v_color;
 
 void main()
 {
@@ -52,11 +52,11 @@ void LUNAPhysicsDebugRenderer::DrawPolygon(const b2Vec2* vertexes, int32 vertexC
 	/*LUNAColor color = FromB2Color(b2dColor, 0.5f);
 	for(int i = 0; i < vertexCount - 1; i++)
 	{
-		LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(
+		LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(
 			vertexes[i].x, vertexes[i].y, vertexes[i + 1].x, vertexes[i + 1].y,
 			color);
 	}
-	LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(
+	LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(
 		vertexes[vertexCount - 1].x, vertexes[vertexCount - 1].y, vertexes[0].x, vertexes[0].y,
 		color);*/
 }
@@ -71,9 +71,9 @@ void LUNAPhysicsDebugRenderer::DrawSolidPolygon(const b2Vec2* vertexes, int32 ve
 		float x2 = LUNAPhysicsUtils::MetersToPixels(vertexes[i + 1].x);
 		float y2 = LUNAPhysicsUtils::MetersToPixels(vertexes[i + 1].y);
 
-		LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(x1, y1, x2, y2, color);
+		LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(x1, y1, x2, y2, color);
 	}
-	LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(
+	LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(
 		LUNAPhysicsUtils::MetersToPixels(vertexes[vertexCount - 1].x),
 		LUNAPhysicsUtils::MetersToPixels(vertexes[vertexCount - 1].y),
 		LUNAPhysicsUtils::MetersToPixels(vertexes[0].x),
@@ -99,7 +99,7 @@ void LUNAPhysicsDebugRenderer::DrawSolidCircle(const b2Vec2& center, float32 rad
 		float x2 = LUNAPhysicsUtils::MetersToPixels(center.x + radius * std::cos(angle2));
 		float y2 = LUNAPhysicsUtils::MetersToPixels(center.y + radius * std::sin(angle2));
 
-		LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(x1, y1, x2, y2, color);
+		LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(x1, y1, x2, y2, color);
 	}
 }
 
@@ -110,7 +110,7 @@ void LUNAPhysicsDebugRenderer::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, c
 	float x2 = LUNAPhysicsUtils::MetersToPixels(p2.x);
 	float y2 = LUNAPhysicsUtils::MetersToPixels(p2.y);
 
-	LUNAEngine::SharedGraphics()->GetRenderer()->RenderLine(x1, y1, x2, y2, FromB2Color(b2dColor));
+	LUNAEngine::SharedGraphics()->GetRenderer()->RenderDebugLine(x1, y1, x2, y2, FromB2Color(b2dColor));
 }
 
 void LUNAPhysicsDebugRenderer::DrawTransform(const b2Transform& xf)
@@ -68,6 +68,7 @@ LUNA_JNI_FUNC(void, LunaNative, reloadAssets)(JNIEnv* env, jclass cls)
 {
 	LUNAEngine::SharedGraphics()->GetRenderer()->SetDefaultViewport();
 	LUNAEngine::SharedGraphics()->GetRenderer()->ReloadDefaultShaders();
+	LUNAEngine::SharedGraphics()->GetRenderer()->ReloadBuffers();
 	LUNAEngine::SharedAssets()->ReloadAssets();
 }
 
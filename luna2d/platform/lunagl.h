@@ -27,18 +27,19 @@
 //-----------------------
 // Include OpenGL headers
 //-----------------------
-#if LUNA_PLATFORM == LUNA_PLATFORM_QT
+// Null backend for benchmarking render path without GPU. Replaces OpenGL for any platform
+#if defined(LUNA_NULL_GL)
+	#include "null/lunanullgl.h"
+
+#elif LUNA_PLATFORM == LUNA_PLATFORM_QT
 	#include "qt/lunaqtgl.h"
-#endif
 
-#if LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
+#elif LUNA_PLATFORM == LUNA_PLATFORM_ANDROID
 	#include "android/lunaandroidgl.h"
-#endif
 
-#if LUNA_PLATFORM == LUNA_PLATFORM_IOS
+#elif LUNA_PLATFORM == LUNA_PLATFORM_IOS
 	#include "ios/lunaiosgl.h"
-#endif
 
-#if LUNA_PLATFORM == LUNA_PLATFORM_WP
+#elif LUNA_PLATFORM == LUNA_PLATFORM_WP
 	#include "wp/lunawpgl.h"
 #endif
\ No newline at end of file
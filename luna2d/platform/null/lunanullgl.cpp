@@ -0,0 +1,599 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunanullgl.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <set>
+#include <unordered_map>
+
+using namespace luna2d;
+
+namespace{
+
+// Vertex attribute array set by "glVertexAttribPointer" without bound array buffer
+struct LUNANullGlClientArray
+{
+	bool enabled = false;
+	const unsigned char* data = nullptr; // Null when attribute is sourced from buffer
+	GLsizei stride = 0;
+	GLsizei elementSize = 0;
+};
+
+// Emulated GL objects and state
+struct LUNANullGlState
+{
+	std::vector<LUNANullGlCall> calls;
+	size_t uploadedBytes = 0;
+	size_t clientArrayBytes = 0;
+	std::vector<unsigned char> clientArrayCopy;
+	LUNANullGlClientArray clientArrays[LUNA_NULL_GL_VERTEX_ATTRIBS];
+
+	GLuint nextId = 1;
+	std::unordered_map<GLuint, std::vector<unsigned char>> buffers;
+	std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> programs; // Attribute and uniform locations
+	std::set<GLuint> shaders, textures, framebuffers;
+	std::set<GLenum> enabledCaps;
+
+	GLuint arrayBuffer = 0;
+	GLuint elementBuffer = 0;
+	GLuint texture = 0;
+	GLuint framebuffer = 0;
+	GLuint program = 0;
+	GLint viewport[4] = {};
+	GLenum error = GL_NO_ERROR;
+};
+
+LUNANullGlState state;
+
+void Record(LUNANullGlCallType type, GLenum target = 0, GLuint object = 0, GLint first = 0, GLsizei count = 0)
+{
+	state.calls.push_back({type, target, object, first, count});
+}
+
+void SetError(GLenum error)
+{
+	if(state.error == GL_NO_ERROR) state.error = error;
+}
+
+// Get data of buffer bound to given target
+std::vector<unsigned char>* GetBoundBufferData(GLenum target)
+{
+	GLuint buffer = LUNANullGl::GetBoundBuffer(target);
+	auto it = state.buffers.find(buffer);
+	return it == state.buffers.end() ? nullptr : &it->second;
+}
+
+void GenObjects(GLsizei n, GLuint* ids)
+{
+	for(int i = 0; i < n; i++) ids[i] = state.nextId++;
+}
+
+// Copy client-side vertex arrays used by draw call, like GL drivers do before drawing from client memory
+// Interleaved attributes of same array are copied as one range
+void CopyClientArrays(GLsizei vertexCount)
+{
+	if(vertexCount <= 0) return;
+
+	std::vector<std::pair<const unsigned char*, const unsigned char*>> ranges;
+	for(const auto& array : state.clientArrays)
+	{
+		if(!array.enabled || !array.data) continue;
+
+		GLsizei stride = array.stride != 0 ? array.stride : array.elementSize;
+		ranges.push_back(std::make_pair(array.data, array.data + (vertexCount - 1) * stride + array.elementSize));
+	}
+
+	// Merge overlapping ranges
+	std::sort(ranges.begin(), ranges.end());
+	size_t size = 0;
+	for(size_t i = 0; i < ranges.size(); i++)
+	{
+		const unsigned char* begin = ranges[i].first;
+		const unsigned char* end = ranges[i].second;
+		while(i + 1 < ranges.size() && ranges[i + 1].first < end) end = std::max(end, ranges[++i].second);
+
+		state.clientArrayCopy.resize(size + (end - begin));
+		std::memcpy(state.clientArrayCopy.data() + size, begin, end - begin);
+		size += end - begin;
+	}
+
+	state.clientArrayBytes += size;
+}
+
+// Get count of vertexes referenced by indexes of "glDrawElements"
+GLsizei GetIndexedVertexCount(GLsizei count, GLenum type, const void* indices)
+{
+	const unsigned char* data = static_cast<const unsigned char*>(indices);
+	if(state.elementBuffer != 0)
+	{
+		auto& buffer = state.buffers[state.elementBuffer];
+		size_t offset = reinterpret_cast<size_t>(indices);
+		size_t indexSize = type == GL_UNSIGNED_SHORT ? 2 : 1;
+		if(offset + count * indexSize > buffer.size()) return 0;
+		data = buffer.data() + offset;
+	}
+	if(!data) return 0;
+
+	GLsizei maxIndex = -1;
+	for(GLsizei i = 0; i < count; i++)
+	{
+		GLsizei index = type == GL_UNSIGNED_SHORT ? reinterpret_cast<const unsigned short*>(data)[i] : data[i];
+		if(index > maxIndex) maxIndex = index;
+	}
+
+	return maxIndex + 1;
+}
+
+// Get location of attribute or uniform with given name. Locations are assigned in order of requests
+GLint GetLocation(GLuint program, const GLchar* name)
+{
+	auto it = state.programs.find(program);
+	if(it == state.programs.end())
+	{
+		SetError(GL_INVALID_OPERATION);
+		return -1;
+	}
+
+	auto& locations = it->second;
+	auto location = locations.find(name);
+	if(location != locations.end()) return location->second;
+
+	GLint ret = locations.size();
+	locations[name] = ret;
+	return ret;
+}
+
+}
+
+const std::vector<LUNANullGlCall>& LUNANullGl::GetCalls()
+{
+	return state.calls;
+}
+
+int LUNANullGl::GetCallsCount(LUNANullGlCallType type)
+{
+	int count = 0;
+	for(const auto& call : state.calls)
+	{
+		if(call.type == type) count++;
+	}
+	return count;
+}
+
+int LUNANullGl::GetDrawCalls()
+{
+	return GetCallsCount(LUNANullGlCallType::DRAW_ARRAYS) + GetCallsCount(LUNANullGlCallType::DRAW_ELEMENTS);
+}
+
+// Bytes uploaded to buffers and textures since last "ClearCalls"
+size_t LUNANullGl::GetUploadedBytes()
+{
+	return state.uploadedBytes;
+}
+
+// Bytes of client-side vertex arrays copied by draw calls since last "ClearCalls"
+size_t LUNANullGl::GetClientArrayBytes()
+{
+	return state.clientArrayBytes;
+}
+
+void LUNANullGl::ClearCalls()
+{
+	state.calls.clear();
+	state.uploadedBytes = 0;
+	state.clientArrayBytes = 0;
+}
+
+// Returns nullptr for unknown buffer
+const std::vector<unsigned char>* LUNANullGl::GetBufferData(GLuint buffer)
+{
+	auto it = state.buffers.find(buffer);
+	return it == state.buffers.end() ? nullptr : &it->second;
+}
+
+GLuint LUNANullGl::GetBoundBuffer(GLenum target)
+{
+	return target == GL_ELEMENT_ARRAY_BUFFER ? state.elementBuffer : state.arrayBuffer;
+}
+
+GLuint LUNANullGl::GetBoundTexture()
+{
+	return state.texture;
+}
+
+GLuint LUNANullGl::GetCurrentProgram()
+{
+	return state.program;
+}
+
+bool LUNANullGl::IsEnabled(GLenum cap)
+{
+	return state.enabledCaps.count(cap) > 0;
+}
+
+void LUNANullGl::ActiveTexture(GLenum texture)
+{
+	if(texture < GL_TEXTURE0) SetError(GL_INVALID_ENUM);
+}
+
+void LUNANullGl::AttachShader(GLuint program, GLuint shader)
+{
+	if(state.programs.count(program) == 0 || state.shaders.count(shader) == 0) SetError(GL_INVALID_VALUE);
+}
+
+void LUNANullGl::BindBuffer(GLenum target, GLuint buffer)
+{
+	if(buffer != 0) state.buffers[buffer];
+
+	if(target == GL_ELEMENT_ARRAY_BUFFER) state.elementBuffer = buffer;
+	else if(target == GL_ARRAY_BUFFER) state.arrayBuffer = buffer;
+	else return SetError(GL_INVALID_ENUM);
+
+	Record(LUNANullGlCallType::BIND_BUFFER, target, buffer);
+}
+
+void LUNANullGl::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	state.framebuffer = framebuffer;
+	Record(LUNANullGlCallType::BIND_FRAMEBUFFER, target, framebuffer);
+}
+
+void LUNANullGl::BindTexture(GLenum target, GLuint texture)
+{
+	state.texture = texture;
+	Record(LUNANullGlCallType::BIND_TEXTURE, target, texture);
+}
+
+void LUNANullGl::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	Record(LUNANullGlCallType::BLEND_FUNC, sfactor, dfactor);
+}
+
+// Alpha factors are not recorded
+void LUNANullGl::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum, GLenum)
+{
+	Record(LUNANullGlCallType::BLEND_FUNC, srcRGB, dstRGB);
+}
+
+void LUNANullGl::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	auto buffer = GetBoundBufferData(target);
+	if(!buffer) return SetError(GL_INVALID_OPERATION);
+
+	buffer->resize(size);
+	if(data) std::memcpy(buffer->data(), data, size);
+	if(data) state.uploadedBytes += size;
+
+	Record(LUNANullGlCallType::BUFFER_DATA, target, GetBoundBuffer(target), 0, size);
+}
+
+void LUNANullGl::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	auto buffer = GetBoundBufferData(target);
+	if(!buffer) return SetError(GL_INVALID_OPERATION);
+	if(offset < 0 || offset + size > static_cast<GLsizeiptr>(buffer->size())) return SetError(GL_INVALID_VALUE);
+
+	std::memcpy(buffer->data() + offset, data, size);
+	state.uploadedBytes += size;
+
+	Record(LUNANullGlCallType::BUFFER_SUB_DATA, target, GetBoundBuffer(target), offset, size);
+}
+
+GLenum LUNANullGl::CheckFramebufferStatus(GLenum target)
+{
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void LUNANullGl::Clear(GLbitfield mask)
+{
+	Record(LUNANullGlCallType::CLEAR, mask);
+}
+
+void LUNANullGl::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+}
+
+void LUNANullGl::CompileShader(GLuint shader)
+{
+}
+
+GLuint LUNANullGl::CreateProgram()
+{
+	GLuint program = state.nextId++;
+	state.programs[program];
+	return program;
+}
+
+GLuint LUNANullGl::CreateShader(GLenum type)
+{
+	GLuint shader = state.nextId++;
+	state.shaders.insert(shader);
+	return shader;
+}
+
+void LUNANullGl::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	for(int i = 0; i < n; i++)
+	{
+		state.buffers.erase(buffers[i]);
+		if(state.arrayBuffer == buffers[i]) state.arrayBuffer = 0;
+		if(state.elementBuffer == buffers[i]) state.elementBuffer = 0;
+	}
+}
+
+void LUNANullGl::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+	for(int i = 0; i < n; i++) state.framebuffers.erase(framebuffers[i]);
+}
+
+void LUNANullGl::DeleteProgram(GLuint program)
+{
+	state.programs.erase(program);
+	if(state.program == program) state.program = 0;
+}
+
+void LUNANullGl::DeleteShader(GLuint shader)
+{
+	state.shaders.erase(shader);
+}
+
+void LUNANullGl::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	for(int i = 0; i < n; i++)
+	{
+		state.textures.erase(textures[i]);
+		if(state.texture == textures[i]) state.texture = 0;
+	}
+}
+
+void LUNANullGl::DepthFunc(GLenum func)
+{
+}
+
+void LUNANullGl::DepthMask(GLboolean flag)
+{
+}
+
+void LUNANullGl::DetachShader(GLuint program, GLuint shader)
+{
+}
+
+void LUNANullGl::Disable(GLenum cap)
+{
+	state.enabledCaps.erase(cap);
+	Record(LUNANullGlCallType::DISABLE, cap);
+}
+
+void LUNANullGl::DisableVertexAttribArray(GLuint index)
+{
+	if(index >= LUNA_NULL_GL_VERTEX_ATTRIBS) return SetError(GL_INVALID_VALUE);
+	state.clientArrays[index].enabled = false;
+}
+
+void LUNANullGl::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	if(state.program == 0) SetError(GL_INVALID_OPERATION);
+	CopyClientArrays(first + count);
+	Record(LUNANullGlCallType::DRAW_ARRAYS, mode, state.program, first, count);
+}
+
+void LUNANullGl::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+	if(state.program == 0) SetError(GL_INVALID_OPERATION);
+	if(type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT) SetError(GL_INVALID_ENUM);
+	else CopyClientArrays(GetIndexedVertexCount(count, type, indices));
+	Record(LUNANullGlCallType::DRAW_ELEMENTS, mode, state.program, 0, count);
+}
+
+void LUNANullGl::Enable(GLenum cap)
+{
+	state.enabledCaps.insert(cap);
+	Record(LUNANullGlCallType::ENABLE, cap);
+}
+
+void LUNANullGl::EnableVertexAttribArray(GLuint index)
+{
+	if(index >= LUNA_NULL_GL_VERTEX_ATTRIBS) return SetError(GL_INVALID_VALUE);
+	state.clientArrays[index].enabled = true;
+}
+
+void LUNANullGl::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	if(state.textures.count(texture) == 0) SetError(GL_INVALID_OPERATION);
+}
+
+void LUNANullGl::GenBuffers(GLsizei n, GLuint* buffers)
+{
+	GenObjects(n, buffers);
+	for(int i = 0; i < n; i++) state.buffers[buffers[i]];
+}
+
+void LUNANullGl::GenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+	GenObjects(n, framebuffers);
+	state.framebuffers.insert(framebuffers, framebuffers + n);
+}
+
+void LUNANullGl::GenTextures(GLsizei n, GLuint* textures)
+{
+	GenObjects(n, textures);
+	state.textures.insert(textures, textures + n);
+}
+
+GLint LUNANullGl::GetAttribLocation(GLuint program, const GLchar* name)
+{
+	return GetLocation(program, name);
+}
+
+GLenum LUNANullGl::GetError()
+{
+	GLenum error = state.error;
+	state.error = GL_NO_ERROR;
+	return error;
+}
+
+void LUNANullGl::GetIntegerv(GLenum pname, GLint* params)
+{
+	if(pname == GL_VIEWPORT) std::memcpy(params, state.viewport, sizeof(state.viewport));
+	else if(pname == GL_FRAMEBUFFER_BINDING) *params = state.framebuffer;
+	else if(pname == GL_DEPTH_BITS) *params = 24; // Default framebuffer is emulated with depth buffer
+	else *params = 0;
+}
+
+void LUNANullGl::GetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+	if(length) *length = 0;
+	if(bufsize > 0) infolog[0] = '\0';
+}
+
+void LUNANullGl::GetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	*params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+
+void LUNANullGl::GetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+	if(length) *length = 0;
+	if(bufsize > 0) infolog[0] = '\0';
+}
+
+void LUNANullGl::GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+	*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+GLint LUNANullGl::GetUniformLocation(GLuint program, const GLchar* name)
+{
+	return GetLocation(program, name);
+}
+
+GLboolean LUNANullGl::IsProgram(GLuint program)
+{
+	return state.programs.count(program) > 0 ? GL_TRUE : GL_FALSE;
+}
+
+GLboolean LUNANullGl::IsTexture(GLuint texture)
+{
+	return state.textures.count(texture) > 0 ? GL_TRUE : GL_FALSE;
+}
+
+void LUNANullGl::LinkProgram(GLuint program)
+{
+}
+
+void LUNANullGl::PixelStorei(GLenum pname, GLint param)
+{
+}
+
+void LUNANullGl::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+	int bytesPerPixel = format == GL_RGBA ? 4 : (format == GL_RGB ? 3 : 1);
+	std::memset(pixels, 0, width * height * bytesPerPixel);
+
+	Record(LUNANullGlCallType::READ_PIXELS, format, state.framebuffer, 0, width * height * bytesPerPixel);
+}
+
+void LUNANullGl::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	Record(LUNANullGlCallType::SCISSOR, 0, 0, x, width);
+}
+
+void LUNANullGl::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+}
+
+void LUNANullGl::TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+	GLenum format, GLenum type, const void* pixels)
+{
+	int bytesPerPixel = format == GL_RGBA ? 4 : (format == GL_RGB ? 3 : 1);
+	int size = width * height * bytesPerPixel;
+	if(pixels) state.uploadedBytes += size;
+
+	Record(LUNANullGlCallType::TEX_IMAGE, target, state.texture, 0, size);
+}
+
+void LUNANullGl::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+}
+
+void LUNANullGl::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels)
+{
+	int bytesPerPixel = format == GL_RGBA ? 4 : (format == GL_RGB ? 3 : 1);
+	int size = width * height * bytesPerPixel;
+	if(pixels) state.uploadedBytes += size;
+
+	Record(LUNANullGlCallType::TEX_IMAGE, target, state.texture, 0, size);
+}
+
+void LUNANullGl::Uniform1i(GLint location, GLint x)
+{
+	Record(LUNANullGlCallType::UNIFORM, 0, location, 0, 1);
+}
+
+void LUNANullGl::Uniform1iv(GLint location, GLsizei count, const GLint* v)
+{
+	Record(LUNANullGlCallType::UNIFORM, 0, location, 0, count);
+}
+
+void LUNANullGl::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	Record(LUNANullGlCallType::UNIFORM, 0, location, 0, count);
+}
+
+void LUNANullGl::UseProgram(GLuint program)
+{
+	if(program != 0 && state.programs.count(program) == 0) return SetError(GL_INVALID_VALUE);
+
+	state.program = program;
+	Record(LUNANullGlCallType::USE_PROGRAM, 0, program);
+}
+
+// Constant attribute values aren't used by null backend
+void LUNANullGl::VertexAttrib4f(GLuint indx, GLfloat, GLfloat, GLfloat, GLfloat)
+{
+	if(indx >= LUNA_NULL_GL_VERTEX_ATTRIBS) SetError(GL_INVALID_VALUE);
+}
+
+// Pointer is saved only for client-side arrays, which are copied on draw calls
+void LUNANullGl::VertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr)
+{
+	if(indx >= LUNA_NULL_GL_VERTEX_ATTRIBS) return SetError(GL_INVALID_VALUE);
+
+	auto& array = state.clientArrays[indx];
+	array.data = state.arrayBuffer == 0 ? static_cast<const unsigned char*>(ptr) : nullptr;
+	array.stride = stride;
+	array.elementSize = size * (type == GL_FLOAT ? sizeof(GLfloat) : type == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : 1);
+}
+
+void LUNANullGl::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	state.viewport[0] = x;
+	state.viewport[1] = y;
+	state.viewport[2] = width;
+	state.viewport[3] = height;
+
+	Record(LUNANullGlCallType::VIEWPORT, 0, 0, x, width);
+}
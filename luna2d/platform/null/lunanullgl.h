@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------
+// Null OpenGL backend. Enabled by "LUNA_NULL_GL" define
+// Records GL calls, buffers and state without rasterizing anything,
+// so render path can be benchmarked and inspected without GPU
+//--------------------------------------------------------------------
+#include <cstddef>
+#include <cstring> // Included by platform GL headers and used by engine code
+#include <vector>
+
+// Types and constants are skipped if real GL headers are already included
+#if !defined(GL_VERSION_1_1) && !defined(GL_ES_VERSION_2_0)
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef void GLvoid;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef char GLchar;
+typedef std::ptrdiff_t GLintptr;
+typedef std::ptrdiff_t GLsizeiptr;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_NO_ERROR 0
+#define GL_INVALID_ENUM 0x0500
+#define GL_INVALID_VALUE 0x0501
+#define GL_INVALID_OPERATION 0x0502
+#define GL_OUT_OF_MEMORY 0x0505
+#define GL_LINES 0x0001
+#define GL_LESS 0x0201
+#define GL_LEQUAL 0x0203
+#define GL_TRIANGLES 0x0004
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_DEPTH_BUFFER_BIT 0x00000100
+#define GL_COLOR_BUFFER_BIT 0x00004000
+#define GL_BLEND 0x0BE2
+#define GL_DEPTH_TEST 0x0B71
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_VIEWPORT 0x0BA2
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_PACK_ALIGNMENT 0x0D05
+#define GL_DEPTH_BITS 0x0D56
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_FLOAT 0x1406
+#define GL_ALPHA 0x1906
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE0 0x84C0
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STREAM_DRAW 0x88E0
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_FRAMEBUFFER 0x8D40
+
+#endif
+
+namespace luna2d{
+
+const int LUNA_NULL_GL_VERTEX_ATTRIBS = 16; // Count of emulated vertex attributes
+
+// Type of recorded GL call
+enum class LUNANullGlCallType
+{
+	DRAW_ARRAYS,
+	DRAW_ELEMENTS,
+	BUFFER_DATA,
+	BUFFER_SUB_DATA,
+	TEX_IMAGE,
+	READ_PIXELS,
+	USE_PROGRAM,
+	BIND_BUFFER,
+	BIND_TEXTURE,
+	BIND_FRAMEBUFFER,
+	ENABLE,
+	DISABLE,
+	BLEND_FUNC,
+	SCISSOR,
+	VIEWPORT,
+	CLEAR,
+	UNIFORM
+};
+
+// Recorded GL call
+struct LUNANullGlCall
+{
+	LUNANullGlCallType type;
+	GLenum target; // Primitive mode for draw calls, target or capability for other calls
+	GLuint object; // Bound object for bind calls, current program for draw calls, uniform location for uniform calls
+	GLint first; // First vertex for "glDrawArrays"
+	GLsizei count; // Count of vertexes or indexes for draw calls, size in bytes for uploads
+};
+
+namespace LUNANullGl{
+
+// Inspecting of recorded command stream
+const std::vector<LUNANullGlCall>& GetCalls();
+int GetCallsCount(LUNANullGlCallType type);
+int GetDrawCalls();
+size_t GetUploadedBytes(); // Bytes uploaded to buffers and textures since last "ClearCalls"
+size_t GetClientArrayBytes(); // Bytes of client-side vertex arrays copied by draw calls since last "ClearCalls"
+void ClearCalls();
+
+// Inspecting of GL state
+const std::vector<unsigned char>* GetBufferData(GLuint buffer); // Returns nullptr for unknown buffer
+GLuint GetBoundBuffer(GLenum target);
+GLuint GetBoundTexture();
+GLuint GetCurrentProgram();
+bool IsEnabled(GLenum cap);
+
+// Emulated GL functions
+void ActiveTexture(GLenum texture);
+void AttachShader(GLuint program, GLuint shader);
+void BindBuffer(GLenum target, GLuint buffer);
+void BindFramebuffer(GLenum target, GLuint framebuffer);
+void BindTexture(GLenum target, GLuint texture);
+void BlendFunc(GLenum sfactor, GLenum dfactor);
+void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+GLenum CheckFramebufferStatus(GLenum target);
+void Clear(GLbitfield mask);
+void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void CompileShader(GLuint shader);
+GLuint CreateProgram();
+GLuint CreateShader(GLenum type);
+void DeleteBuffers(GLsizei n, const GLuint* buffers);
+void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void DeleteProgram(GLuint program);
+void DeleteShader(GLuint shader);
+void DeleteTextures(GLsizei n, const GLuint* textures);
+void DepthFunc(GLenum func);
+void DepthMask(GLboolean flag);
+void DetachShader(GLuint program, GLuint shader);
+void Disable(GLenum cap);
+void DisableVertexAttribArray(GLuint index);
+void DrawArrays(GLenum mode, GLint first, GLsizei count);
+void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void Enable(GLenum cap);
+void EnableVertexAttribArray(GLuint index);
+void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void GenBuffers(GLsizei n, GLuint* buffers);
+void GenFramebuffers(GLsizei n, GLuint* framebuffers);
+void GenTextures(GLsizei n, GLuint* textures);
+GLint GetAttribLocation(GLuint program, const GLchar* name);
+GLenum GetError();
+void GetIntegerv(GLenum pname, GLint* params);
+void GetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void GetProgramiv(GLuint program, GLenum pname, GLint* params);
+void GetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void GetShaderiv(GLuint shader, GLenum pname, GLint* params);
+GLint GetUniformLocation(GLuint program, const GLchar* name);
+GLboolean IsProgram(GLuint program);
+GLboolean IsTexture(GLuint texture);
+void LinkProgram(GLuint program);
+void PixelStorei(GLenum pname, GLint param);
+void ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+	GLenum format, GLenum type, const void* pixels);
+void TexParameteri(GLenum target, GLenum pname, GLint param);
+void TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels);
+void Uniform1i(GLint location, GLint x);
+void Uniform1iv(GLint location, GLsizei count, const GLint* v);
+void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void UseProgram(GLuint program);
+void VertexAttrib4f(GLuint indx, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+void VertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr);
+void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+}}
+
+#define glActiveTexture luna2d::LUNANullGl::ActiveTexture
+#define glAttachShader luna2d::LUNANullGl::AttachShader
+#define glBindBuffer luna2d::LUNANullGl::BindBuffer
+#define glBindFramebuffer luna2d::LUNANullGl::BindFramebuffer
+#define glBindTexture luna2d::LUNANullGl::BindTexture
+#define glBlendFunc luna2d::LUNANullGl::BlendFunc
+#define glBlendFuncSeparate luna2d::LUNANullGl::BlendFuncSeparate
+#define glBufferData luna2d::LUNANullGl::BufferData
+#define glBufferSubData luna2d::LUNANullGl::BufferSubData
+#define glCheckFramebufferStatus luna2d::LUNANullGl::CheckFramebufferStatus
+#define glClear luna2d::LUNANullGl::Clear
+#define glClearColor luna2d::LUNANullGl::ClearColor
+#define glCompileShader luna2d::LUNANullGl::CompileShader
+#define glCreateProgram luna2d::LUNANullGl::CreateProgram
+#define glCreateShader luna2d::LUNANullGl::CreateShader
+#define glDeleteBuffers luna2d::LUNANullGl::DeleteBuffers
+#define glDeleteFramebuffers luna2d::LUNANullGl::DeleteFramebuffers
+#define glDeleteProgram luna2d::LUNANullGl::DeleteProgram
+#define glDeleteShader luna2d::LUNANullGl::DeleteShader
+#define glDeleteTextures luna2d::LUNANullGl::DeleteTextures
+#define glDepthFunc luna2d::LUNANullGl::DepthFunc
+#define glDepthMask luna2d::LUNANullGl::DepthMask
+#define glDetachShader luna2d::LUNANullGl::DetachShader
+#define glDisable luna2d::LUNANullGl::Disable
+#define glDisableVertexAttribArray luna2d::LUNANullGl::DisableVertexAttribArray
+#define glDrawArrays luna2d::LUNANullGl::DrawArrays
+#define glDrawElements luna2d::LUNANullGl::DrawElements
+#define glEnable luna2d::LUNANullGl::Enable
+#define glEnableVertexAttribArray luna2d::LUNANullGl::EnableVertexAttribArray
+#define glFramebufferTexture2D luna2d::LUNANullGl::FramebufferTexture2D
+#define glGenBuffers luna2d::LUNANullGl::GenBuffers
+#define glGenFramebuffers luna2d::LUNANullGl::GenFramebuffers
+#define glGenTextures luna2d::LUNANullGl::GenTextures
+#define glGetAttribLocation luna2d::LUNANullGl::GetAttribLocation
+#define glGetError luna2d::LUNANullGl::GetError
+#define glGetIntegerv luna2d::LUNANullGl::GetIntegerv
+#define glGetProgramInfoLog luna2d::LUNANullGl::GetProgramInfoLog
+#define glGetProgramiv luna2d::LUNANullGl::GetProgramiv
+#define glGetShaderInfoLog luna2d::LUNANullGl::GetShaderInfoLog
+#define glGetShaderiv luna2d::LUNANullGl::GetShaderiv
+#define glGetUniformLocation luna2d::LUNANullGl::GetUniformLocation
+#define glIsProgram luna2d::LUNANullGl::IsProgram
+#define glIsTexture luna2d::LUNANullGl::IsTexture
+#define glLinkProgram luna2d::LUNANullGl::LinkProgram
+#define glPixelStorei luna2d::LUNANullGl::PixelStorei
+#define glReadPixels luna2d::LUNANullGl::ReadPixels
+#define glScissor luna2d::LUNANullGl::Scissor
+#define glShaderSource luna2d::LUNANullGl::ShaderSource
+#define glTexImage2D luna2d::LUNANullGl::TexImage2D
+#define glTexParameteri luna2d::LUNANullGl::TexParameteri
+#define glTexSubImage2D luna2d::LUNANullGl::TexSubImage2D
+#define glUniform1i luna2d::LUNANullGl::Uniform1i
+#define glUniform1iv luna2d::LUNANullGl::Uniform1iv
+#define glUniformMatrix4fv luna2d::LUNANullGl::UniformMatrix4fv
+#define glUseProgram luna2d::LUNANullGl::UseProgram
+#define glVertexAttrib4f luna2d::LUNANullGl::VertexAttrib4f
+#define glVertexAttribPointer luna2d::LUNANullGl::VertexAttribPointer
+#define glViewport luna2d::LUNANullGl::Viewport
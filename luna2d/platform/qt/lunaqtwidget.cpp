@@ -70,9 +70,11 @@ float LUNAQtWidget::TranslateMouseY(int y)
 
 void LUNAQtWidget::initializeGL()
 {
+#if !defined(LUNA_NULL_GL)
 	// Set methods from current QOpenGLFunctions object as usual GL functions
 	// SEE "platform/qt/lunaqtgl.h"
 	LUNAQtGl::InitFunctions();
+#endif
 
 	paintDevice = new QOpenGLPaintDevice();
 
@@ -26,6 +26,14 @@
 
 using namespace luna2d;
 
+#ifdef LUNA_DEBUG
+static int errorCheckInterval = 1;
+#else
+static int errorCheckInterval = 100;
+#endif
+
+static int errorCheckCounter = 0;
+
 // Get error string from error code
 const char* luna2d::glErrorString(GLenum error)
 {
@@ -49,6 +57,9 @@ const char* luna2d::glErrorString(GLenum error)
 // Wrapper for glGetError
 void luna2d::glCheckError(const char* file, int line)
 {
+   if(errorCheckInterval <= 0 || ++errorCheckCounter < errorCheckInterval) return;
+   errorCheckCounter = 0;
+
    GLenum error = glGetError();
    if(error != GL_NO_ERROR)
    {
@@ -56,3 +67,15 @@ void luna2d::glCheckError(const char* file, int line)
 	   else LUNA_LOGE("%s(%d)", glErrorString(error), error);
    }
 }
+
+// Set how often "glCheckError" actually checks errors: once per given count of calls. 0 disables checking
+void luna2d::glSetErrorCheckInterval(int interval)
+{
+	errorCheckInterval = interval;
+	errorCheckCounter = 0;
+}
+
+int luna2d::glGetErrorCheckInterval()
+{
+	return errorCheckInterval;
+}
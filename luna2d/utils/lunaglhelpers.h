@@ -37,4 +37,10 @@ namespace luna2d{
 const char* glErrorString(GLenum error); // Get error string from error code
 void glCheckError(const char* file = nullptr, int line = -1); // Wrapper for glGetError
 
+// Set how often "glCheckError" actually checks errors: once per given count of calls. 0 disables checking
+// Every check forces synchronization with GPU, so in release builds errors are checked selectively
+// GL errors are kept until checked, so sampled check still reports error, but with less accurate location
+void glSetErrorCheckInterval(int interval);
+int glGetErrorCheckInterval();
+
 }
@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "lunaworkerpool.h"
+#include <algorithm>
+
+using namespace luna2d;
+
+const int MAX_WORKER_THREADS = 7;
+
+LUNAWorkerPool::LUNAWorkerPool(int threadsCount) :
+	threadsCount(std::max(threadsCount, 0))
+{
+}
+
+LUNAWorkerPool::~LUNAWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	wakeCondition.notify_all();
+	for(auto& thread : threads) thread.join();
+}
+
+void LUNAWorkerPool::WorkerLoop()
+{
+	unsigned int seenGeneration = 0;
+
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeCondition.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+
+			if(stopping) return;
+			seenGeneration = generation;
+		}
+
+		RunJobs(seenGeneration);
+	}
+}
+
+// Take and run jobs of given parallel call until all jobs are taken
+void LUNAWorkerPool::RunJobs(unsigned int generation)
+{
+	while(true)
+	{
+		const LUNAWorkerJob* curJob;
+		size_t first, last;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(this->generation != generation || nextJob >= jobsCount) return;
+
+			curJob = job;
+			first = nextJob * jobSize;
+			last = std::min(first + jobSize, count);
+			nextJob++;
+		}
+
+		(*curJob)(first, last);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(++finishedJobs == jobsCount) doneCondition.notify_all();
+	}
+}
+
+// Get count of worker threads. Calling thread is also used to run jobs
+int LUNAWorkerPool::GetThreadsCount()
+{
+	return threadsCount;
+}
+
+// Split given count of items into ranges of "jobSize" items and run job for each range
+// Ranges are run on worker threads and calling thread. Returns when all ranges are done
+void LUNAWorkerPool::ParallelFor(size_t count, size_t jobSize, const LUNAWorkerJob& job)
+{
+	if(count == 0) return;
+	if(jobSize == 0) jobSize = count;
+
+	// Not enough work to share
+	if(threadsCount == 0 || count <= jobSize)
+	{
+		SerialFor(count, jobSize, job);
+		return;
+	}
+
+	if(threads.empty())
+	{
+		for(int i = 0; i < threadsCount; i++) threads.emplace_back(&LUNAWorkerPool::WorkerLoop, this);
+	}
+
+	unsigned int curGeneration;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->count = count;
+		this->jobSize = jobSize;
+		jobsCount = (count + jobSize - 1) / jobSize;
+		nextJob = 0;
+		finishedJobs = 0;
+		curGeneration = ++generation;
+	}
+
+	wakeCondition.notify_all();
+	RunJobs(curGeneration);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [&]() { return finishedJobs == jobsCount; });
+	this->job = nullptr;
+}
+
+// Same as "ParallelFor", but runs all ranges on calling thread
+void LUNAWorkerPool::SerialFor(size_t count, size_t jobSize, const LUNAWorkerJob& job)
+{
+	if(jobSize == 0) jobSize = count;
+
+	for(size_t first = 0; first < count; first += jobSize) job(first, std::min(first + jobSize, count));
+}
+
+// Get recommended count of worker threads for this device
+int LUNAWorkerPool::GetDefaultThreadsCount()
+{
+	int cores = std::thread::hardware_concurrency();
+	return std::min(std::max(cores - 1, 0), MAX_WORKER_THREADS);
+}
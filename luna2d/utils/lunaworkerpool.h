@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace luna2d{
+
+// Job for range of items [first, last)
+typedef std::function<void(size_t first, size_t last)> LUNAWorkerJob;
+
+//-------------------------------------------------------------------
+// Pool of worker threads for splitting work into independent ranges
+// Threads are started on first parallel call and sleep between calls
+//-------------------------------------------------------------------
+class LUNAWorkerPool
+{
+public:
+	LUNAWorkerPool(int threadsCount);
+	~LUNAWorkerPool();
+
+private:
+	int threadsCount;
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wakeCondition, doneCondition;
+
+	// Current parallel call. Guarded by mutex
+	const LUNAWorkerJob* job = nullptr;
+	size_t count = 0;
+	size_t jobSize = 0;
+	size_t jobsCount = 0;
+	size_t nextJob = 0;
+	size_t finishedJobs = 0;
+	unsigned int generation = 0;
+	bool stopping = false;
+
+private:
+	void WorkerLoop();
+
+	// Take and run jobs of given parallel call until all jobs are taken
+	void RunJobs(unsigned int generation);
+
+public:
+	// Get count of worker threads. Calling thread is also used to run jobs
+	int GetThreadsCount();
+
+	// Split given count of items into ranges of "jobSize" items and run job for each range
+	// Ranges are run on worker threads and calling thread. Returns when all ranges are done
+	void ParallelFor(size_t count, size_t jobSize, const LUNAWorkerJob& job);
+
+	// Same as "ParallelFor", but runs all ranges on calling thread
+	static void SerialFor(size_t count, size_t jobSize, const LUNAWorkerJob& job);
+
+	// Get recommended count of worker threads for this device
+	static int GetDefaultThreadsCount();
+};
+
+}
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// luna2d engine
+// Copyright 2014-2017 Stepan Prokofjev
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Headless driver of renderer on null OpenGL backend
+// Runs frames through "BeginRender", "Render" and "EndRender" and
+// checks count of draw calls recorded by "LUNANullGl"
+// Benchmark mode compares CPU cost of streaming batches through
+// vertex buffers and drawing them from client-side arrays
+// Usage: lunarenderbench
+//        lunarenderbench bench [sprites] [frames]
+//-----------------------------------------------------------------
+#include "lunaengine.h"
+#include "lunagraphics.h"
+#include "lunanullgl.h"
+#include "lunaqtfiles.h"
+#include "lunaqtlog.h"
+#include "lunaqtutils.h"
+#include "lunaqtprefs.h"
+#include "lunaqtservices.h"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+
+using namespace luna2d;
+
+static std::shared_ptr<LUNATexture> textureA;
+static std::shared_ptr<LUNATexture> textureB;
+
+// Assemble engine from Qt platform modules with minimal game in temporary folder
+static bool InitializeEngine(const QString& gamePath)
+{
+	QFile config(gamePath + "/" + QString::fromStdString(CONFIG_FILENAME));
+	if(!config.open(QIODevice::WriteOnly)) return false;
+	config.write("{ \"name\": \"renderbench\" }");
+	config.close();
+
+	LUNAQtLog* log = new LUNAQtLog();
+	QObject::connect(log, &LUNAQtLog::logError, [](const QString& message)
+	{
+		std::fprintf(stderr, "Error: %s\n", message.toUtf8().constData());
+	});
+
+	LUNAEngine::Shared()->Assemble(new LUNAQtFiles(gamePath), log, new LUNAQtUtils(nullptr, 0, 0), new LUNAQtPrefs(), new LUNAQtServices());
+	LUNAEngine::Shared()->Initialize(1280, 720);
+
+	return LUNAEngine::Shared()->IsInitialized();
+}
+
+static void RenderSprite(LUNARenderer* renderer, float x, float y, float size, const LUNAMaterial* material)
+{
+	renderer->RenderQuad(x, y, 0, 1, x, y + size, 0, 0, x + size, y + size, 1, 0, x + size, y, 1, 1, material, LUNAColor::WHITE);
+}
+
+// Render one frame with given submitting function and get count of draw calls in it
+static int RenderFrame(LUNARenderer* renderer, const std::function<void()>& submit)
+{
+	renderer->BeginRender();
+	LUNANullGl::ClearCalls();
+	submit();
+	renderer->EndRender();
+
+	return LUNANullGl::GetDrawCalls();
+}
+
+static bool CheckDrawCalls(const char* name, int expected, int actual)
+{
+	if(expected == actual) return true;
+
+	std::fprintf(stderr, "FAIL %s: expected %d draw calls, got %d\n", name, expected, actual);
+	return false;
+}
+
+// Check draw calls of typical frames with and without vertex buffers
+static bool RunTests()
+{
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	LUNAMaterial materialA(textureA, renderer->GetDefaultShader(), LUNABlendingMode::ALPHA);
+	LUNAMaterial materialB(textureB, renderer->GetDefaultShader(), LUNABlendingMode::ALPHA);
+	LUNAMaterial materialAdditive(textureA, renderer->GetDefaultShader(), LUNABlendingMode::ADDITIVE);
+	bool passed = true;
+
+	auto spritesSameMaterial = [&]()
+	{
+		for(int i = 0; i < 100; i++) RenderSprite(renderer, (i % 10) * 20.0f, (i / 10) * 20.0f, 16.0f, &materialA);
+	};
+
+	auto spritesAlternateTextures = [&]()
+	{
+		for(int i = 0; i < 10; i++) RenderSprite(renderer, i * 20.0f, 0, 16.0f, i % 2 == 0 ? &materialA : &materialB);
+	};
+
+	auto spriteLineSprite = [&]()
+	{
+		RenderSprite(renderer, 0, 0, 16.0f, &materialA);
+		renderer->RenderLine(0, 0, 100.0f, 100.0f, LUNAColor::WHITE);
+		RenderSprite(renderer, 20.0f, 0, 16.0f, &materialA);
+	};
+
+	auto spritesThenLines = [&]()
+	{
+		RenderSprite(renderer, 0, 0, 16.0f, &materialA);
+		RenderSprite(renderer, 20.0f, 0, 16.0f, &materialA);
+		renderer->RenderLine(0, 0, 100.0f, 100.0f, LUNAColor::WHITE);
+		renderer->RenderLine(0, 100.0f, 100.0f, 0, LUNAColor::WHITE);
+	};
+
+	auto spritesBlendingChange = [&]()
+	{
+		RenderSprite(renderer, 0, 0, 16.0f, &materialA);
+		RenderSprite(renderer, 20.0f, 0, 16.0f, &materialAdditive);
+	};
+
+	for(bool vertexBuffers : { true, false })
+	{
+		renderer->EnableVertexBuffers(vertexBuffers);
+		std::printf("Vertex buffers %s\n", vertexBuffers ? "enabled" : "disabled");
+
+		passed &= CheckDrawCalls("sprites with same material", 1, RenderFrame(renderer, spritesSameMaterial));
+		passed &= CheckDrawCalls("sprites with alternate textures", 10, RenderFrame(renderer, spritesAlternateTextures));
+		passed &= CheckDrawCalls("line between sprites", 3, RenderFrame(renderer, spriteLineSprite));
+		passed &= CheckDrawCalls("lines after sprites", 2, RenderFrame(renderer, spritesThenLines));
+		passed &= CheckDrawCalls("blending change", 2, RenderFrame(renderer, spritesBlendingChange));
+
+		renderer->EnableMultiTexture(true);
+		passed &= CheckDrawCalls("alternate textures with multi-texture batching", 1, RenderFrame(renderer, spritesAlternateTextures));
+		renderer->EnableMultiTexture(false);
+
+		renderer->EnableRenderSorting(true);
+		passed &= CheckDrawCalls("alternate textures with render sorting", 2, RenderFrame(renderer, spritesAlternateTextures));
+		renderer->EnableRenderSorting(false);
+	}
+
+	renderer->EnableVertexBuffers(true);
+	return passed;
+}
+
+// Render frames of moving sprites with vertex buffers enabled and disabled and print time per frame
+// Null backend copies client arrays at draw call like GL driver does, so both paths do comparable work
+static void RunBenchmark(int sprites, int frames)
+{
+	LUNARenderer* renderer = LUNAEngine::SharedGraphics()->GetRenderer();
+	LUNAMaterial material(textureA, renderer->GetDefaultShader(), LUNABlendingMode::ALPHA);
+
+	std::vector<float> xs(sprites), ys(sprites);
+	std::srand(1);
+	for(int i = 0; i < sprites; i++)
+	{
+		xs[i] = std::rand() % 460;
+		ys[i] = std::rand() % 300;
+	}
+
+	const int WARMUP_FRAMES = 30;
+
+	for(bool vertexBuffers : { true, false })
+	{
+		renderer->EnableVertexBuffers(vertexBuffers);
+		double submitTime = 0;
+		double endTime = 0;
+		size_t uploadedBytes = 0;
+		size_t clientBytes = 0;
+		int drawCalls = 0;
+
+		for(int frame = -WARMUP_FRAMES; frame < frames; frame++)
+		{
+			LUNANullGl::ClearCalls();
+			auto beginTime = std::chrono::steady_clock::now();
+
+			renderer->BeginRender();
+			for(int i = 0; i < sprites; i++) RenderSprite(renderer, xs[i] + frame % 10, ys[i], 16.0f, &material);
+			auto submitEndTime = std::chrono::steady_clock::now();
+			renderer->EndRender();
+
+			auto endRenderTime = std::chrono::steady_clock::now();
+			if(frame < 0) continue;
+
+			submitTime += std::chrono::duration<double, std::micro>(submitEndTime - beginTime).count();
+			endTime += std::chrono::duration<double, std::micro>(endRenderTime - submitEndTime).count();
+			uploadedBytes += LUNANullGl::GetUploadedBytes();
+			clientBytes += LUNANullGl::GetClientArrayBytes();
+			drawCalls += LUNANullGl::GetDrawCalls();
+		}
+
+		std::printf("%-14s sprites: %d, frames: %d, submit: %.1f us, EndRender: %.1f us, total: %.1f us, "
+			"draw calls: %d, uploaded: %zu B, client arrays: %zu B (per frame)\n",
+			vertexBuffers ? "vertex buffers" : "client arrays", sprites, frames,
+			submitTime / frames, endTime / frames, (submitTime + endTime) / frames,
+			drawCalls / frames, uploadedBytes / frames, clientBytes / frames);
+	}
+
+	renderer->EnableVertexBuffers(true);
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	QTemporaryDir gameDir;
+	if(!gameDir.isValid() || !InitializeEngine(gameDir.path()))
+	{
+		std::fprintf(stderr, "Cannot initialize engine\n");
+		return 1;
+	}
+
+	textureA = std::make_shared<LUNATexture>(64, 64, LUNAColorType::RGBA);
+	textureB = std::make_shared<LUNATexture>(64, 64, LUNAColorType::RGBA);
+
+	bool passed = true;
+	if(argc > 1 && std::string(argv[1]) == "bench")
+	{
+		int sprites = argc > 2 ? std::atoi(argv[2]) : 10000;
+		int frames = argc > 3 ? std::atoi(argv[3]) : 300;
+		if(sprites > 0 && frames > 0) RunBenchmark(sprites, frames);
+	}
+	else
+	{
+		passed = RunTests();
+		std::printf(passed ? "All tests passed\n" : "Some tests failed\n");
+	}
+
+	textureA.reset();
+	textureB.reset();
+	LUNAEngine::Shared()->Deinitialize();
+
+	return passed ? 0 : 1;
+}